@@ -0,0 +1,563 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+#include "maze.h"
+#include "mesh.h"
+#include "solver.h"
+#include "timing.h"
+
+// benchmark for maze generation, solving and mesh building. sweeps square mazes from 10x10 up to
+// --max-size with fixed seeds and writes one JSON record per (phase, size). with --baseline it also
+// compares against an older run and exits with 1 if anything got slower than --threshold allows.
+// it also exits with 1 if the parallel generator gives a different maze for a different thread count
+
+typedef struct {
+    char phase[32];
+    int width, height;
+    double seconds;          // best of --repeat runs
+    double cells_per_second;
+    long peak_rss_kb;        // high water mark while the phase ran
+    long vertices;           // vertices emitted, mesh phases only
+    long scratch_kb;         // solver workspace size, solve phases only
+    long work;               // chambers split or cells expanded
+} BenchResult;
+
+typedef struct {
+    BenchResult *items;
+    int count, capacity;
+} BenchResults;
+
+typedef struct {
+    int max_size;
+    int mesh_max_size;
+    int repeat;
+    int threads;
+    uint64_t seed;
+    const char *output;
+    const char *baseline;
+    double threshold;
+    double min_time;
+} BenchOptions;
+
+static void results_push(BenchResults *r, BenchResult result) {
+    if (r->count == r->capacity) {
+        r->capacity = r->capacity ? r->capacity * 2 : 64;
+        r->items = (BenchResult *)realloc(r->items, sizeof(BenchResult) * r->capacity);
+        if (!r->items) {
+            fprintf(stderr, "Failed to reallocate memory for bench results.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    r->items[r->count++] = result;
+}
+
+// on linux the peak can be reset between phases, elsewhere its the peak for the whole process
+static void reset_peak_rss(void) {
+#ifdef __linux__
+    FILE *fp = fopen("/proc/self/clear_refs", "w");
+    if (fp) {
+        fputs("5", fp);
+        fclose(fp);
+    }
+#endif
+}
+
+static long peak_rss_kb(void) {
+#ifdef __linux__
+    FILE *fp = fopen("/proc/self/status", "r");
+    if (fp) {
+        char line[256];
+        long kb = -1;
+        while (fgets(line, sizeof(line), fp)) {
+            if (sscanf(line, "VmHWM: %ld kB", &kb) == 1) break;
+        }
+        fclose(fp);
+        if (kb >= 0) return kb;
+    }
+#endif
+#ifdef _WIN32
+    return 0;
+#else
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1024; // bytes on mac
+#else
+    return usage.ru_maxrss;
+#endif
+#endif
+}
+
+static void record(BenchResults *results, const char *phase, int size, double seconds, long rss,
+                   long vertices, long work, long scratch_kb) {
+    BenchResult r;
+    memset(&r, 0, sizeof(r));
+    snprintf(r.phase, sizeof(r.phase), "%s", phase);
+    r.width = size;
+    r.height = size;
+    r.seconds = seconds;
+    r.cells_per_second = seconds > 0 ? (double)size * size / seconds : 0.0;
+    r.peak_rss_kb = rss;
+    r.vertices = vertices;
+    r.scratch_kb = scratch_kb;
+    r.work = work;
+    results_push(results, r);
+    fprintf(stderr, "%-24s %5dx%-5d %10.3f ms %14.0f cells/s %8ld kB", phase, size, size, seconds * 1000.0,
+            r.cells_per_second, rss);
+    if (scratch_kb > 0) fprintf(stderr, " %8ld kB scratch", scratch_kb);
+    fprintf(stderr, "\n");
+}
+
+// which generator a generation phase runs
+enum { GEN_RECURSIVE, GEN_ITERATIVE, GEN_PARALLEL, GEN_ELLER };
+
+// eller's rows are thrown away so only the generator itself is timed
+static void discard_row(void *user, int row, const uint64_t *north, const uint64_t *west, int cols) {
+}
+
+static void bench_generate(BenchResults *results, const BenchOptions *opts, int size, int kind, const char *phase) {
+    double best = -1;
+    long chambers = 0;
+    long rss = 0;
+    for (int rep = 0; rep < opts->repeat; rep++) {
+        Maze m = {0, 0, 0, NULL, NULL, 0};
+        Rng rng;
+        rng_seed(&rng, opts->seed, 0);
+        reset_peak_rss();
+        double start = now_seconds();
+        if (kind != GEN_ELLER) {
+            // eller streams its rows, the maze is never allocated
+            allocate_maze(&m, size, size);
+            init_maze(&m);
+        }
+        if (kind == GEN_RECURSIVE) chambers = generate_maze(&m, &rng, 0, size - 1, 0, size - 1);
+        else if (kind == GEN_ITERATIVE) chambers = generate_maze_iterative(&m, &rng, 0, size - 1, 0, size - 1);
+        else if (kind == GEN_PARALLEL) chambers = generate_maze_parallel(&m, opts->seed, opts->threads);
+        else chambers = generate_maze_eller(size, size, &rng, discard_row, NULL);
+        double seconds = now_seconds() - start;
+        rss = peak_rss_kb();
+        if (best < 0 || seconds < best) best = seconds;
+        free_maze(&m);
+    }
+    record(results, phase, size, best, rss, 0, chambers, 0);
+}
+
+// the parallel generator promises the same walls for any thread count, which is what lets --threads
+// change without changing the maze. checked with 1, 2 and 16 threads at every size, not timed
+static bool check_parallel_identical(const BenchOptions *opts, int size) {
+    static const int thread_counts[] = {1, 2, 16};
+    Maze first;
+    make_maze_parallel(&first, size, size, opts->seed, thread_counts[0]);
+    bool same = true;
+    for (int i = 1; i < 3; i++) {
+        Maze m;
+        make_maze_parallel(&m, size, size, opts->seed, thread_counts[i]);
+        if (memcmp(first.bits, m.bits, maze_bytes(&m)) != 0) {
+            fprintf(stderr, "generate_parallel %dx%d: %d threads gave a different maze than 1 thread\n", size, size,
+                    thread_counts[i]);
+            same = false;
+        }
+        free_maze(&m);
+    }
+    free_maze(&first);
+    return same;
+}
+
+static void bench_solvers(BenchResults *results, const BenchOptions *opts, const Maze *m, int size) {
+    int num_solvers;
+    const SolverInfo *solvers = get_solvers(&num_solvers);
+    Path path;
+    path_init(&path);
+
+    for (int s = 0; s < num_solvers; s++) {
+        double best = -1;
+        long rss = 0;
+        // a fresh workspace per solver so scratch only counts what that solver allocates.
+        // the untimed warm up allocates and pages it in once, then it gets reused like headless does.
+        // field, tree, hpa, junction and dstar keep what they found in the workspace, so it is marked
+        // stale before every timed run or they would just replay the warm up's answer
+        SolverWorkspace ws;
+        workspace_init(&ws);
+        solvers[s].solve(m, maze_entrance(m), maze_exit(m), &ws, &path);
+        for (int rep = 0; rep < opts->repeat; rep++) {
+            workspace_maze_changed(&ws);
+            reset_peak_rss();
+            double start = now_seconds();
+            solvers[s].solve(m, maze_entrance(m), maze_exit(m), &ws, &path);
+            double seconds = now_seconds() - start;
+            rss = peak_rss_kb();
+            if (best < 0 || seconds < best) best = seconds;
+        }
+        char phase[32];
+        snprintf(phase, sizeof(phase), "solve_%s", solvers[s].name);
+        record(results, phase, size, best, rss, 0, path.expanded, (long)(workspace_bytes(&ws) / 1024));
+        workspace_free(&ws);
+    }
+    path_free(&path);
+}
+
+// bfs-parallel with 1, 2, 4, 8 and 16 threads, one phase each plus a speedup line against 1 thread.
+// only levels with PARALLEL_BFS_CUTOFF frontier cells are split, and a perfect maze's frontier stays in the
+// hundreds, so there it measures the serial bfs plus starting the threads. the line says how many levels
+// (and what share of the cells) really ran on the threads
+static void bench_bfs_scaling(BenchResults *results, const BenchOptions *opts, const Maze *m, int size,
+                              const char *name) {
+    Path path;
+    path_init(&path);
+    double one_thread = 0;
+    char report[256];
+    int used = snprintf(report, sizeof(report), "%s scaling %dx%d:", name, size, size);
+    int levels = 0, parallel_levels = 0;
+    long parallel_cells = 0;
+
+    for (int threads = 1; threads <= 16; threads *= 2) {
+        SolverWorkspace ws;
+        workspace_init(&ws);
+        ws.num_threads = threads;
+        solve_bfs_parallel(m, maze_entrance(m), maze_exit(m), &ws, &path);
+        double best = -1;
+        long rss = 0;
+        for (int rep = 0; rep < opts->repeat; rep++) {
+            reset_peak_rss();
+            double start = now_seconds();
+            solve_bfs_parallel(m, maze_entrance(m), maze_exit(m), &ws, &path);
+            double seconds = now_seconds() - start;
+            rss = peak_rss_kb();
+            if (best < 0 || seconds < best) best = seconds;
+        }
+        char phase[32];
+        snprintf(phase, sizeof(phase), "solve_%s_t%d", name, threads);
+        record(results, phase, size, best, rss, 0, path.expanded, (long)(workspace_bytes(&ws) / 1024));
+        if (threads > 1) {
+            levels = ws.levels;
+            parallel_levels = ws.parallel_levels;
+            parallel_cells = ws.parallel_cells;
+        }
+        workspace_free(&ws);
+
+        if (threads == 1) one_thread = best;
+        if (used < (int)sizeof(report)) {
+            used += snprintf(report + used, sizeof(report) - used, " %dt %.2fx", threads,
+                             best > 0 ? one_thread / best : 0.0);
+        }
+    }
+    fprintf(stderr, "%s (%d of %d levels split, %.0f%% of %ld cells)\n", report, parallel_levels, levels,
+            path.expanded > 0 ? 100.0 * parallel_cells / path.expanded : 0.0, path.expanded);
+    path_free(&path);
+}
+
+// the tree index is built once per maze and then answers lots of distance queries, so the build and a
+// batch of random queries are timed as separate phases
+#define TREE_QUERIES 100000
+
+static void bench_tree_queries(BenchResults *results, const BenchOptions *opts, const Maze *m, int size) {
+    SolverWorkspace ws;
+    workspace_init(&ws);
+    double build_best = -1, query_best = -1;
+    long build_rss = 0, query_rss = 0;
+    long total = 0;
+    for (int rep = 0; rep < opts->repeat; rep++) {
+        reset_peak_rss();
+        double start = now_seconds();
+        tree_index_build(&ws.tree, m);
+        double seconds = now_seconds() - start;
+        build_rss = peak_rss_kb();
+        if (build_best < 0 || seconds < build_best) build_best = seconds;
+
+        // same queries every rep
+        Rng rng;
+        rng_seed(&rng, opts->seed, 2);
+        total = 0;
+        reset_peak_rss();
+        start = now_seconds();
+        for (int q = 0; q < TREE_QUERIES; q++) {
+            CellPos a = {(int)rng_bounded(&rng, m->rows), (int)rng_bounded(&rng, m->cols)};
+            CellPos b = {(int)rng_bounded(&rng, m->rows), (int)rng_bounded(&rng, m->cols)};
+            total += tree_distance(m, a, b, &ws);
+        }
+        seconds = now_seconds() - start;
+        query_rss = peak_rss_kb();
+        if (query_best < 0 || seconds < query_best) query_best = seconds;
+    }
+    long scratch = (long)(workspace_bytes(&ws) / 1024);
+    record(results, "tree_build", size, build_best, build_rss, 0, ws.tree.is_tree, scratch);
+    record(results, "tree_distance", size, query_best, query_rss, 0, TREE_QUERIES, scratch);
+    if (total < 0) fprintf(stderr, "unreachable cells in a generated maze\n"); // also keeps the loop alive
+    workspace_free(&ws);
+}
+
+// d* lite repairing its route after a wall changes. random inner walls are flipped and flipped back on a copy
+// of the maze, the phase is the average time of one repair
+#define DSTAR_CHANGES 20
+
+static void bench_dstar_repair(BenchResults *results, const BenchOptions *opts, const Maze *m, int size) {
+    Maze copy;
+    allocate_maze(&copy, m->rows, m->cols);
+    memcpy(copy.bits, m->bits, maze_bytes(m));
+    SolverWorkspace ws;
+    workspace_init(&ws);
+    Path path;
+    path_init(&path);
+    solve_dstar(&copy, maze_entrance(&copy), maze_exit(&copy), &ws, &path); // the full first search
+
+    Rng rng;
+    rng_seed(&rng, opts->seed, 3);
+    double total = 0;
+    long settled = 0;
+    reset_peak_rss();
+    for (int i = 0; i < DSTAR_CHANGES; i++) {
+        int row, col, dir;
+        do {
+            row = (int)rng_bounded(&rng, copy.rows);
+            col = (int)rng_bounded(&rng, copy.cols);
+            dir = (int)rng_bounded(&rng, 4);
+        } while (row + d_row[dir] < 0 || row + d_row[dir] >= copy.rows ||
+                 col + d_col[dir] < 0 || col + d_col[dir] >= copy.cols);
+        for (int flip = 0; flip < 2; flip++) {
+            maze_toggle_wall(&copy, row, col, dir);
+            workspace_wall_changed(&ws, &copy, row, col, dir);
+            double start = now_seconds();
+            solve_dstar(&copy, maze_entrance(&copy), maze_exit(&copy), &ws, &path);
+            total += now_seconds() - start;
+            settled += path.expanded;
+        }
+    }
+    record(results, "dstar_repair", size, total / (2 * DSTAR_CHANGES), peak_rss_kb(), 0, settled,
+           (long)(workspace_bytes(&ws) / 1024));
+    workspace_free(&ws);
+    path_free(&path);
+    free_maze(&copy);
+}
+
+// a batch of routes with their paths: BATCH_QUERIES random starts spread over BATCH_GOALS random goals, on
+// --threads threads. each goal is one search however many queries share it
+#define BATCH_QUERIES 1024
+#define BATCH_GOALS 8
+
+static void bench_batch(BenchResults *results, const BenchOptions *opts, const Maze *m, int size) {
+    RouteQuery *queries = (RouteQuery *)malloc(sizeof(RouteQuery) * BATCH_QUERIES);
+    if (!queries) {
+        fprintf(stderr, "Failed to allocate memory for batch queries.\n");
+        exit(EXIT_FAILURE);
+    }
+    Rng rng;
+    rng_seed(&rng, opts->seed, 4);
+    CellPos goals[BATCH_GOALS];
+    for (int g = 0; g < BATCH_GOALS; g++) {
+        goals[g] = (CellPos){(int)rng_bounded(&rng, m->rows), (int)rng_bounded(&rng, m->cols)};
+    }
+    for (int q = 0; q < BATCH_QUERIES; q++) {
+        queries[q].start = (CellPos){(int)rng_bounded(&rng, m->rows), (int)rng_bounded(&rng, m->cols)};
+        queries[q].goal = goals[q % BATCH_GOALS];
+    }
+
+    RouteBatch batch;
+    route_batch_init(&batch);
+    double best = -1;
+    long rss = 0;
+    for (int rep = 0; rep < opts->repeat; rep++) {
+        reset_peak_rss();
+        double start = now_seconds();
+        solve_batch(m, queries, BATCH_QUERIES, true, opts->threads, &batch);
+        double seconds = now_seconds() - start;
+        rss = peak_rss_kb();
+        if (best < 0 || seconds < best) best = seconds;
+    }
+    record(results, "batch_routes", size, best, rss, 0, batch.expanded,
+           (long)((batch.run_capacity * sizeof(PathRun) + batch.num_fields * goal_field_bytes(&batch.fields[0])) / 1024));
+    route_batch_free(&batch);
+    free(queries);
+}
+
+// building the hpa index on its own, solve_hpa's phase is a build plus one query
+static void bench_hpa_build(BenchResults *results, const BenchOptions *opts, const Maze *m, int size) {
+    HpaIndex h;
+    hpa_index_init(&h);
+    double best = -1;
+    long rss = 0;
+    for (int rep = 0; rep < opts->repeat; rep++) {
+        reset_peak_rss();
+        double start = now_seconds();
+        hpa_index_build(&h, m);
+        double seconds = now_seconds() - start;
+        rss = peak_rss_kb();
+        if (best < 0 || seconds < best) best = seconds;
+    }
+    record(results, "hpa_build", size, best, rss, 0, h.num_nodes, (long)(hpa_index_bytes(&h) / 1024));
+    hpa_index_free(&h);
+}
+
+// each mesh part on its own so the vertex count per phase is visible
+static void bench_mesh(BenchResults *results, const BenchOptions *opts, const Maze *m, int size) {
+    const char *phases[] = {"mesh_floor", "mesh_poles", "mesh_walls"};
+    init_block();
+
+    for (int p = 0; p < 3; p++) {
+        double best = -1;
+        long vertices = 0;
+        long rss = 0;
+        for (int rep = 0; rep < opts->repeat; rep++) {
+            Rng rng;
+            rng_seed(&rng, opts->seed, 1);
+            free_mesh();
+            reset_peak_rss();
+            double start = now_seconds();
+            if (p == 0) generate_maze_floor(m->cols, m->rows);
+            else if (p == 1) generate_maze_poles(m->cols, m->rows, &rng);
+            else generate_maze_walls(m, &rng);
+            double seconds = now_seconds() - start;
+            rss = peak_rss_kb();
+            vertices = num_vertices;
+            if (best < 0 || seconds < best) best = seconds;
+        }
+        record(results, phases[p], size, best, rss, vertices, 0, 0);
+    }
+    free_mesh();
+}
+
+static void write_json(FILE *out, const BenchOptions *opts, const BenchResults *results) {
+    fprintf(out, "{\n  \"seed\": %llu,\n  \"threads\": %d,\n  \"repeat\": %d,\n  \"results\": [\n",
+            (unsigned long long)opts->seed, opts->threads, opts->repeat);
+    // one record per line, the baseline reader depends on that
+    for (int i = 0; i < results->count; i++) {
+        const BenchResult *r = &results->items[i];
+        fprintf(out, "    {\"phase\": \"%s\", \"width\": %d, \"height\": %d, \"seconds\": %.9f, "
+                     "\"cells_per_second\": %.1f, \"peak_rss_kb\": %ld, \"vertices\": %ld, \"work\": %ld, "
+                     "\"scratch_kb\": %ld}%s\n",
+                r->phase, r->width, r->height, r->seconds, r->cells_per_second, r->peak_rss_kb, r->vertices,
+                r->work, r->scratch_kb, i + 1 < results->count ? "," : "");
+    }
+    fprintf(out, "  ]\n}\n");
+}
+
+static bool read_baseline(const char *filename, BenchResults *baseline) {
+    FILE *fp = fopen(filename, "r");
+    if (!fp) {
+        perror(filename);
+        return false;
+    }
+    char line[512];
+    while (fgets(line, sizeof(line), fp)) {
+        BenchResult r;
+        memset(&r, 0, sizeof(r));
+        if (sscanf(line, " {\"phase\": \"%31[^\"]\", \"width\": %d, \"height\": %d, \"seconds\": %lf",
+                   r.phase, &r.width, &r.height, &r.seconds) == 4) {
+            results_push(baseline, r);
+        }
+    }
+    fclose(fp);
+    return true;
+}
+
+// returns the number of phases that got slower than the threshold
+static int compare_baseline(const BenchResults *baseline, const BenchResults *results, const BenchOptions *opts) {
+    int regressions = 0;
+    for (int i = 0; i < results->count; i++) {
+        const BenchResult *now = &results->items[i];
+        for (int j = 0; j < baseline->count; j++) {
+            const BenchResult *old = &baseline->items[j];
+            if (strcmp(old->phase, now->phase) != 0 || old->width != now->width || old->height != now->height) continue;
+
+            // really short phases are mostly noise
+            if (old->seconds >= opts->min_time && now->seconds > old->seconds * (1.0 + opts->threshold)) {
+                fprintf(stderr, "REGRESSION %s %dx%d: %.3f ms -> %.3f ms (+%.1f%%)\n", now->phase, now->width,
+                        now->height, old->seconds * 1000.0, now->seconds * 1000.0,
+                        (now->seconds / old->seconds - 1.0) * 100.0);
+                regressions++;
+            }
+            break;
+        }
+    }
+    return regressions;
+}
+
+static void usage(const char *name) {
+    fprintf(stderr,
+            "usage: %s [--max-size N] [--mesh-max-size N] [--repeat N] [--threads N] [--seed N]\n"
+            "          [--output FILE] [--baseline FILE] [--threshold F] [--min-time SECONDS]\n",
+            name);
+}
+
+int main(int argc, char **argv) {
+    BenchOptions opts = {4096, 64, 1, 4, 1, NULL, NULL, 0.10, 0.001};
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--max-size") == 0 && i + 1 < argc) opts.max_size = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--mesh-max-size") == 0 && i + 1 < argc) opts.mesh_max_size = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) opts.repeat = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) opts.threads = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) opts.seed = strtoull(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc) opts.output = argv[++i];
+        else if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc) opts.baseline = argv[++i];
+        else if (strcmp(argv[i], "--threshold") == 0 && i + 1 < argc) opts.threshold = atof(argv[++i]);
+        else if (strcmp(argv[i], "--min-time") == 0 && i + 1 < argc) opts.min_time = atof(argv[++i]);
+        else {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (opts.repeat < 1) opts.repeat = 1;
+
+    BenchResults results = {NULL, 0, 0};
+    int status = EXIT_SUCCESS;
+
+    // 10x10, then powers of two
+    for (int size = 10; size <= opts.max_size; size = (size < 16) ? 16 : size * 2) {
+        bench_generate(&results, &opts, size, GEN_RECURSIVE, "generate_recursive");
+        bench_generate(&results, &opts, size, GEN_ITERATIVE, "generate_iterative");
+        bench_generate(&results, &opts, size, GEN_PARALLEL, "generate_parallel");
+        if (!check_parallel_identical(&opts, size)) status = EXIT_FAILURE;
+        bench_generate(&results, &opts, size, GEN_ELLER, "generate_eller");
+
+        Maze m;
+        Rng rng;
+        rng_seed(&rng, opts.seed, 0);
+        make_maze(&m, size, size, &rng);
+        bench_solvers(&results, &opts, &m, size);
+        bench_bfs_scaling(&results, &opts, &m, size, "bfs-parallel");
+        // the same maze with a quarter of the inner walls gone: the frontier grows to about the maze's width,
+        // so on big mazes most cells are in levels that get split
+        Maze open;
+        rng_seed(&rng, opts.seed, 0);
+        make_maze(&open, size, size, &rng);
+        rng_seed(&rng, opts.seed, 5);
+        maze_add_loops(&open, &rng, 25);
+        bench_bfs_scaling(&results, &opts, &open, size, "bfs-parallel-loops");
+        free_maze(&open);
+        bench_tree_queries(&results, &opts, &m, size);
+        bench_hpa_build(&results, &opts, &m, size);
+        bench_dstar_repair(&results, &opts, &m, size);
+        bench_batch(&results, &opts, &m, size);
+        if (size <= opts.mesh_max_size) {
+            bench_mesh(&results, &opts, &m, size);
+        }
+        free_maze(&m);
+    }
+
+    FILE *out = stdout;
+    if (opts.output) {
+        out = fopen(opts.output, "w");
+        if (!out) {
+            perror(opts.output);
+            return EXIT_FAILURE;
+        }
+    }
+    write_json(out, &opts, &results);
+    if (out != stdout) fclose(out);
+
+    if (opts.baseline) {
+        BenchResults baseline = {NULL, 0, 0};
+        if (!read_baseline(opts.baseline, &baseline)) return EXIT_FAILURE;
+        int regressions = compare_baseline(&baseline, &results, &opts);
+        fprintf(stderr, "%d regression(s) beyond %.0f%% against %s\n", regressions, opts.threshold * 100.0,
+                opts.baseline);
+        if (regressions > 0) status = EXIT_FAILURE;
+        free(baseline.items);
+    }
+
+    free(results.items);
+    return status;
+}
@@ -0,0 +1,263 @@
+#include "headless.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "maze.h"
+#include "maze_export.h"
+#include "maze_file.h"
+#include "solver.h"
+#include "timing.h"
+
+// options that are followed by a value
+static bool takes_value(const char *option) {
+    static const char *names[] = {"--threads", "--seed", "--width", "--height", "--count", "--solver", "--output",
+                                  "--generator", "--format", "--load", "--save", "--export", "--save-path"};
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+        if (strcmp(option, names[i]) == 0) return true;
+    }
+    return false;
+}
+
+bool headless_parse_args(int argc, char **argv, HeadlessOptions *opts) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--headless") == 0) {
+            opts->headless = true;
+        } else if (strcmp(argv[i], "--stream") == 0) {
+            opts->stream = true;
+        } else if (!takes_value(argv[i])) {
+            fprintf(stderr, "Unknown option '%s'.\n", argv[i]);
+            return false;
+        } else if (i + 1 == argc) {
+            fprintf(stderr, "%s needs a value.\n", argv[i]);
+            return false;
+        } else if (strcmp(argv[i], "--threads") == 0) {
+            opts->threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0) {
+            opts->seed = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--width") == 0) {
+            opts->width = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--height") == 0) {
+            opts->height = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--count") == 0) {
+            opts->count = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--solver") == 0) {
+            opts->solver = argv[++i];
+        } else if (strcmp(argv[i], "--output") == 0) {
+            opts->output = argv[++i];
+        } else if (strcmp(argv[i], "--generator") == 0) {
+            opts->generator = argv[++i];
+        } else if (strcmp(argv[i], "--format") == 0) {
+            opts->format = argv[++i];
+        } else if (strcmp(argv[i], "--load") == 0) {
+            opts->load = argv[++i];
+        } else if (strcmp(argv[i], "--save") == 0) {
+            opts->save = argv[++i];
+        } else if (strcmp(argv[i], "--export") == 0) {
+            opts->export_file = argv[++i];
+        } else if (strcmp(argv[i], "--save-path") == 0) {
+            opts->path_file = argv[++i];
+        }
+    }
+    return true;
+}
+
+// eller's rows go straight to the output as they are finished, nothing the size of the maze is ever
+// allocated. text mazes are separated by a blank line and the stats go to stderr.
+// format is an EXPORT_* value, or -1 for the binary maze file
+static int run_stream(const HeadlessOptions *opts, FILE *out, int format) {
+    double total_start = now_seconds();
+    for (int i = 0; i < opts->count; i++) {
+        uint64_t maze_seed = opts->seed + (uint64_t)i;
+        Rng rng;
+        rng_seed(&rng, maze_seed, 0);
+
+        double gen_start = now_seconds();
+        long passages;
+        if (format < 0) {
+            setvbuf(out, NULL, _IOFBF, 1 << 20); // rows are only a few words each
+            MazeFileHeader header;
+            maze_file_header(&header, opts->height, opts->width, maze_seed, MAZE_GEN_ELLER);
+            maze_file_write_header(out, &header);
+            passages = generate_maze_eller(opts->height, opts->width, &rng, maze_file_row, out);
+        } else {
+            if (i > 0 && format == EXPORT_ASCII) fputc('\n', out);
+            MazeExporter exporter;
+            exporter_open(&exporter, out, format, opts->height, opts->width);
+            passages = generate_maze_eller(opts->height, opts->width, &rng, exporter_row, &exporter);
+            exporter_close(&exporter);
+        }
+        double gen_ms = (now_seconds() - gen_start) * 1000.0;
+        fprintf(stderr, "maze %d seed %llu %dx%d: %ld passages in %.3f ms\n", i, (unsigned long long)maze_seed,
+                opts->width, opts->height, passages, gen_ms);
+    }
+
+    double total_seconds = now_seconds() - total_start;
+    fprintf(stderr, "Headless: streamed %d mazes in %.3f s\n", opts->count, total_seconds);
+    bool ok = !ferror(out);
+    if (out != stdout && fclose(out) != 0) ok = false;
+    if (!ok) {
+        fprintf(stderr, "Failed to write the streamed maze.\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+// generate and solve opts->count mazes without GL, one result line per maze.
+// returns the process exit code
+int run_headless(const HeadlessOptions *opts) {
+    if (!opts->load && (opts->width <= 0 || opts->height <= 0)) {
+        fprintf(stderr, "Headless mode needs --width and --height (positive integers) or --load.\n");
+        return EXIT_FAILURE;
+    }
+
+    bool eller = opts->generator && strcmp(opts->generator, "eller") == 0;
+    if (opts->generator && !eller && strcmp(opts->generator, "division") != 0) {
+        fprintf(stderr, "Unknown generator '%s'. Available generators: division, eller\n", opts->generator);
+        return EXIT_FAILURE;
+    }
+    bool binary = opts->format && strcmp(opts->format, "bin") == 0;
+    int format = opts->format ? export_format_from_name(opts->format) : EXPORT_ASCII;
+    if (!binary && format < 0) {
+        fprintf(stderr, "Unknown format '%s'. Available formats: ascii, pbm, svg, bin\n", opts->format);
+        return EXIT_FAILURE;
+    }
+    if (opts->stream && !eller) {
+        fprintf(stderr, "--stream needs --generator eller.\n");
+        return EXIT_FAILURE;
+    }
+    // a maze file, image or path file holds exactly one maze
+    if ((opts->save || opts->export_file || opts->path_file || (opts->stream && (binary || format != EXPORT_ASCII))) &&
+        opts->count != 1) {
+        fprintf(stderr, "Maze files, images and paths hold one maze, use --count 1.\n");
+        return EXIT_FAILURE;
+    }
+
+    const SolverInfo *solver = find_solver(opts->solver);
+    if (!solver) {
+        fprintf(stderr, "Unknown solver '%s'. Available solvers: ", opts->solver);
+        list_solvers(stderr);
+        return EXIT_FAILURE;
+    }
+
+    if (!opts->stream && !opts->load && !maze_fits_solvers(opts->height, opts->width)) {
+        return EXIT_FAILURE;
+    }
+
+    FILE *out = stdout;
+    if (opts->output) {
+        out = fopen(opts->output, opts->stream ? "wb" : "w");
+        if (!out) {
+            perror(opts->output);
+            return EXIT_FAILURE;
+        }
+    }
+    if (opts->stream) {
+        return run_stream(opts, out, binary ? -1 : format);
+    }
+
+    fprintf(out, "# maze seed width height chambers gen_ms solver solved length expanded solve_ms\n");
+
+    // one path and workspace for the whole batch, they only grow when a bigger maze comes along
+    Path path;
+    path_init(&path);
+    SolverWorkspace ws;
+    workspace_init(&ws);
+    ws.num_threads = opts->threads; // for --solver bfs-parallel
+    int solved_count = 0;
+    int count = opts->load ? 1 : opts->count;
+    double total_start = now_seconds();
+
+    for (int i = 0; i < count; i++) {
+        uint64_t maze_seed = opts->seed + (uint64_t)i;
+        Maze m;
+        Rng rng;
+        rng_seed(&rng, maze_seed, 0);
+
+        // a loaded maze reports its load time as gen_ms and 0 chambers
+        double gen_start = now_seconds();
+        long chambers = 0; // eller has no chambers, it reports the passages it carved instead
+        uint32_t generator = MAZE_GEN_DIVISION_PARALLEL;
+        if (opts->load) {
+            MazeFileHeader header;
+            if (!maze_load(&m, opts->load, &header)) {
+                workspace_free(&ws);
+                path_free(&path);
+                if (out != stdout) fclose(out);
+                return EXIT_FAILURE;
+            }
+            maze_seed = header.seed;
+            if (!maze_fits_solvers(m.rows, m.cols)) {
+                free_maze(&m);
+                workspace_free(&ws);
+                path_free(&path);
+                if (out != stdout) fclose(out);
+                return EXIT_FAILURE;
+            }
+        } else if (eller) {
+            chambers = make_maze_eller(&m, opts->height, opts->width, &rng);
+            generator = MAZE_GEN_ELLER;
+        } else {
+            // the per chamber streams make the maze independent of --threads
+            chambers = make_maze_parallel(&m, opts->height, opts->width, maze_seed, opts->threads);
+        }
+        double gen_ms = (now_seconds() - gen_start) * 1000.0;
+        workspace_maze_changed(&ws); // a new maze can end up at the same address as the last one
+        if ((opts->save && !maze_save(&m, opts->save, maze_seed, generator)) ||
+            (opts->export_file && !export_maze_file(&m, opts->export_file, export_format_from_filename(opts->export_file)))) {
+            free_maze(&m);
+            workspace_free(&ws);
+            path_free(&path);
+            if (out != stdout) fclose(out);
+            return EXIT_FAILURE;
+        }
+
+        // the hpa index is built once per maze, its cost goes to stderr so solve_ms stays one query
+        if (solver->solve == solve_hpa) {
+            double build_start = now_seconds();
+            hpa_index_build(&ws.hpa, &m);
+            fprintf(stderr, "maze %d: hpa index built in %.3f ms, %d nodes, %zu edges, %zu kB\n", i,
+                    (now_seconds() - build_start) * 1000.0, ws.hpa.num_nodes, ws.hpa.num_edges,
+                    hpa_index_bytes(&ws.hpa) / 1024);
+        }
+
+        double solve_start = now_seconds();
+        bool solved = solver->solve(&m, maze_entrance(&m), maze_exit(&m), &ws, &path);
+        double solve_ms = (now_seconds() - solve_start) * 1000.0;
+        if (solved) solved_count++;
+        if (opts->path_file) {
+            if (!solved) {
+                fprintf(stderr, "No path to save, the maze wasn't solved.\n");
+            } else {
+                RunPath runs;
+                run_path_init(&runs);
+                path_to_runs(&path, &runs);
+                fprintf(stderr, "maze %d: %d cells in %d runs, %zu bytes instead of %zu\n", i, path.length,
+                        runs.num_runs, (size_t)runs.num_runs * sizeof(PathRun), (size_t)path.length * sizeof(CellPos));
+                bool saved = run_path_save(&runs, opts->path_file);
+                run_path_free(&runs);
+                if (!saved) {
+                    free_maze(&m);
+                    workspace_free(&ws);
+                    path_free(&path);
+                    if (out != stdout) fclose(out);
+                    return EXIT_FAILURE;
+                }
+            }
+        }
+
+        fprintf(out, "%d %llu %d %d %ld %.3f %s %d %d %ld %.3f\n", i, (unsigned long long)maze_seed,
+                m.cols, m.rows, chambers, gen_ms, solver->name, solved ? 1 : 0,
+                solved ? path.length : 0, path.expanded, solve_ms);
+
+        free_maze(&m);
+    }
+
+    double total_seconds = now_seconds() - total_start;
+    fprintf(stderr, "Headless: %d mazes (%d solved) in %.3f s, %.1f mazes/s\n", count, solved_count,
+            total_seconds, total_seconds > 0 ? count / total_seconds : 0.0);
+
+    workspace_free(&ws);
+    path_free(&path);
+    if (out != stdout) fclose(out);
+    return EXIT_SUCCESS;
+}
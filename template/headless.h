@@ -0,0 +1,31 @@
+#ifndef _HEADLESS_H_
+#define _HEADLESS_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// command line settings. the viewer uses seed, threads, solver, load, save and export_file too
+typedef struct {
+    bool headless;        // --headless, run the batch instead of opening the viewer
+    int width;            // maze size along x (columns)
+    int height;           // maze size along z (rows)
+    uint64_t seed;        // maze i is generated from seed + i
+    int count;            // how many mazes to make
+    int threads;          // generator and solver threads, the maze is the same for any count
+    const char *generator; // "division" (default) or "eller"
+    bool stream;          // eller only, write each maze out row by row while generating instead of solving it
+    const char *format;   // --stream output, "ascii" (default), "pbm", "svg" or "bin" (maze_file.h)
+    const char *load;     // solve this maze file instead of generating
+    const char *save;     // write the generated maze here, needs count == 1
+    const char *export_file; // ascii/pbm/svg picked from the extension, needs count == 1
+    const char *path_file; // the solved path as straight runs (run_path_save), needs count == 1
+    const char *solver;   // name from find_solver()
+    const char *output;   // NULL writes to stdout
+} HeadlessOptions;
+
+// fills in opts from argv, leaving whatever isnt given as it was. false (after printing why) for an
+// unknown option or one missing its value
+bool headless_parse_args(int argc, char **argv, HeadlessOptions *opts);
+int run_headless(const HeadlessOptions *opts);
+
+#endif
@@ -0,0 +1,15 @@
+#include <stdlib.h>
+#include <time.h>
+#include "headless.h"
+
+// the headless batch mode on its own, without GL or GLUT linked in, for machines with no display.
+// takes the same options as ./template --headless (--headless itself is accepted and ignored)
+
+int main(int argc, char **argv) {
+    HeadlessOptions opts = {.count = 1, .threads = 1, .solver = "bfs"};
+    opts.seed = (uint64_t)time(NULL);
+    if (!headless_parse_args(argc, argv, &opts)) {
+        return EXIT_FAILURE;
+    }
+    return run_headless(&opts);
+}
@@ -0,0 +1,244 @@
+#include "maze.h"
+#include "maze_export.h"
+#include "maze_file.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//allocate mem for maze size, one block for the whole grid
+void allocate_maze(Maze *m, int rows, int cols) {
+    m->rows = rows;
+    m->cols = cols;
+    m->words_per_plane = (cols + 1 + 63) / 64; // +1 for the east border column
+    m->mapping = NULL;
+    m->mapping_bytes = 0;
+
+    // +1 row for the south border
+    m->bits = (uint64_t *)calloc((size_t)(rows + 1) * 2 * m->words_per_plane, sizeof(uint64_t));
+    if (!m->bits) {
+        fprintf(stderr, "Failed to allocate memory for maze.\n");
+        exit(EXIT_FAILURE);
+    }
+}
+
+//teardown
+void free_maze(Maze *m) {
+    if (m->mapping) {
+        maze_file_unmap(m); // loaded with maze_load, the bits belong to the mapping
+    } else if (m->bits) {
+        free(m->bits);
+    }
+    m->bits = NULL;
+    m->rows = 0;
+    m->cols = 0;
+}
+
+//size of the wall store in bytes
+size_t maze_bytes(const Maze *m) {
+    return (size_t)(m->rows + 1) * 2 * m->words_per_plane * sizeof(uint64_t);
+}
+
+// create the maze with bording walls + the entrance and exit and all the walls inside should be disabled for now
+void init_maze(Maze *m) {
+    int rows = m->rows;
+    int cols = m->cols;
+    memset(m->bits, 0, maze_bytes(m));
+
+    // set border walls
+    for (int j = 0; j < cols; j++) {
+        maze_set_wall(m, 0, j, NORTH, true);
+        maze_set_wall(m, rows - 1, j, SOUTH, true);
+    }
+    for (int i = 0; i < rows; i++) {
+        maze_set_wall(m, i, 0, WEST, true);
+        maze_set_wall(m, i, cols - 1, EAST, true);
+    }
+
+    // create entrance (remove bottom left, bottom wall)
+    maze_set_wall(m, rows - 1, 0, SOUTH, false);
+
+    // create exit (remove top right, top wall)
+    maze_set_wall(m, 0, cols - 1, NORTH, false);
+}
+
+// every chamber gets a stream that only depends on the seed and where the chamber is,
+// so it doesnt matter which thread splits it or in what order
+Rng chamber_rng(uint64_t seed, const Chamber *c) {
+    uint64_t state = seed;
+    uint64_t coords[4] = {(uint64_t)c->row_start, (uint64_t)c->row_end, (uint64_t)c->col_start, (uint64_t)c->col_end};
+    for (int i = 0; i < 4; i++) {
+        state ^= coords[i];
+        state = rng_mix64(&state);
+    }
+    Rng rng;
+    rng_seed(&rng, state, seed);
+    return rng;
+}
+
+// set/clear a wall bit. chambers split on different threads can share a 64 bit word at their edges,
+// so the parallel generator passes shared = true to do the update atomically
+static void put_wall(Maze *m, int row, int col, int direction, bool wall, bool shared) {
+    if (!shared) {
+        maze_set_wall(m, row, col, direction, wall);
+        return;
+    }
+    uint64_t *plane = (direction == NORTH) ? maze_north_row(m, row) : maze_west_row(m, row);
+    uint64_t mask = (uint64_t)1 << (col & 63);
+    if (wall) __atomic_fetch_or(&plane[col >> 6], mask, __ATOMIC_RELAXED);
+    else __atomic_fetch_and(&plane[col >> 6], ~mask, __ATOMIC_RELAXED);
+}
+
+// split one chamber with a horizontal and a vertical wall and open three of the four new walls.
+// fills in the dividing row/col so the caller can work out the four sub chambers
+void divide_chamber(Maze *m, const Chamber *chamber, Rng *rng, bool shared,
+                    int *divide_row_out, int *divide_col_out) {
+    int row_start = chamber->row_start, row_end = chamber->row_end;
+    int col_start = chamber->col_start, col_end = chamber->col_end;
+
+    // randomly pick a dividing row and column
+    int divide_row = rng_between(rng, row_start + 1, row_end); // ensure its not on a boundary
+    int divide_col = rng_between(rng, col_start + 1, col_end);
+
+    // add walls vertically and horisontally from that point
+    // (the west wall of the right section is the same bit as the east wall of the left section)
+
+    //vert wall
+    for (int r = row_start; r <= row_end; r++) {
+        put_wall(m, r, divide_col, WEST, true, shared);
+    }
+
+    //horizontal wall
+    for (int c = col_start; c <= col_end; c++) {
+        put_wall(m, divide_row, c, NORTH, true, shared);
+    }
+
+    // next, randomly open one wall in three of the four sections
+    bool opened[4] = {false, false, false, false}; // track which walls have been opened
+    int directions[] = {0, 1, 2, 3};              // directions: 0=N, 1=E, 2=S, 3=W
+    for (int i = 0; i < 3; i++) {
+        int dir_idx = rng_between(rng, 0, 4 - i); // pick random direction
+        int dir = directions[dir_idx];
+        directions[dir_idx] = directions[3 - i]; // remove this direction from pool so its not picked again
+
+        // open a wall in the chosen direction
+        if (dir == 0 && !opened[0]) { // north
+            int col = rng_between(rng, col_start, divide_col); //pick seg to open
+            put_wall(m, divide_row, col, NORTH, false, shared);
+            opened[0] = true;
+        } else if (dir == 1 && !opened[1]) { // east
+            int row = rng_between(rng, row_start, divide_row);
+            put_wall(m, row, divide_col, WEST, false, shared);
+            opened[1] = true;
+        } else if (dir == 2 && !opened[2]) { // south
+            int col = rng_between(rng, divide_col, col_end + 1);
+            put_wall(m, divide_row, col, NORTH, false, shared);
+            opened[2] = true;
+        } else if (dir == 3 && !opened[3]) { // west
+            int row = rng_between(rng, divide_row, row_end + 1);
+            put_wall(m, row, divide_col, WEST, false, shared);
+            opened[3] = true;
+        }
+    }
+
+    *divide_row_out = divide_row;
+    *divide_col_out = divide_col;
+}
+
+//function to randomly generate the maze, returns the number of chambers that were split
+long generate_maze(Maze *m, Rng *rng, int row_start, int row_end, int col_start, int col_end) {
+    // if the chamber is too small, stop recursion here
+    if (row_end - row_start < 1 || col_end - col_start < 1) {
+        return 0;
+    }
+
+    int divide_row, divide_col;
+    Chamber c = {row_start, row_end, col_start, col_end};
+    divide_chamber(m, &c, rng, false, &divide_row, &divide_col);
+
+    // recursive call for each chamber made from this division
+    long chambers = 1;
+    chambers += generate_maze(m, rng, row_start, divide_row - 1, col_start, divide_col - 1); // top left
+    chambers += generate_maze(m, rng, row_start, divide_row - 1, divide_col, col_end);       // top right
+    chambers += generate_maze(m, rng, divide_row, row_end, col_start, divide_col - 1);       // bottom left
+    chambers += generate_maze(m, rng, divide_row, row_end, divide_col, col_end);             // bottom right
+    return chambers;
+}
+
+// same as generate_maze but keeps the pending chambers on a heap stack instead of the call stack,
+// so tall/narrow mazes cant overflow it. chambers are popped in the same order the recursion
+// visits them which means the random draws line up and the same seed gives the same maze
+long generate_maze_iterative(Maze *m, Rng *rng, int row_start, int row_end, int col_start, int col_end) {
+    int capacity = 64;
+    int top = 0;
+    Chamber *stack = (Chamber *)malloc(sizeof(Chamber) * capacity);
+    if (!stack) {
+        fprintf(stderr, "Failed to allocate memory for generator stack.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    long chambers = 0;
+    stack[top++] = (Chamber){row_start, row_end, col_start, col_end};
+
+    while (top > 0) {
+        Chamber c = stack[--top];
+
+        // too small to split
+        if (c.row_end - c.row_start < 1 || c.col_end - c.col_start < 1) {
+            continue;
+        }
+
+        int divide_row, divide_col;
+        divide_chamber(m, &c, rng, false, &divide_row, &divide_col);
+        chambers++;
+
+        // make room for the 4 sub chambers
+        if (top + 4 > capacity) {
+            capacity *= 2;
+            stack = (Chamber *)realloc(stack, sizeof(Chamber) * capacity);
+            if (!stack) {
+                fprintf(stderr, "Failed to reallocate memory for generator stack.\n");
+                exit(EXIT_FAILURE);
+            }
+        }
+
+        // pushed in reverse so top left comes off first, like the recursive version
+        stack[top++] = (Chamber){divide_row, c.row_end, divide_col, c.col_end};           // bottom right
+        stack[top++] = (Chamber){divide_row, c.row_end, c.col_start, divide_col - 1};     // bottom left
+        stack[top++] = (Chamber){c.row_start, divide_row - 1, divide_col, c.col_end};     // top right
+        stack[top++] = (Chamber){c.row_start, divide_row - 1, c.col_start, divide_col - 1}; // top left
+    }
+
+    free(stack);
+    return chambers;
+}
+
+// bang. maze time. returns the number of chambers the generator split
+long make_maze(Maze *m, int rows, int cols, Rng *rng) {
+    allocate_maze(m, rows, cols);
+    init_maze(m);
+    return generate_maze_iterative(m, rng, 0, rows - 1, 0, cols - 1);
+}
+
+// knock down about percent of the inner walls so the maze has loops, returns how many came down.
+// the generators only make perfect mazes, this is for testing solvers on wide open ones
+long maze_add_loops(Maze *m, Rng *rng, int percent) {
+    long removed = 0;
+    for (int row = 0; row < m->rows; row++) {
+        for (int col = 0; col < m->cols; col++) {
+            if (row > 0 && maze_has_wall(m, row, col, NORTH) && (int)rng_bounded(rng, 100) < percent) {
+                maze_set_wall(m, row, col, NORTH, false);
+                removed++;
+            }
+            if (col > 0 && maze_has_wall(m, row, col, WEST) && (int)rng_bounded(rng, 100) < percent) {
+                maze_set_wall(m, row, col, WEST, false);
+                removed++;
+            }
+        }
+    }
+    return removed;
+}
+
+//function to print a text version of the maze so i know its correct
+void print_maze(const Maze *m) {
+    export_maze(m, stdout, EXPORT_ASCII);
+}
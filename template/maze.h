@@ -0,0 +1,115 @@
+#ifndef _MAZE_H_
+#define _MAZE_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "rng.h"
+
+// the maze is stored as two bitplanes with one bit per cell: the cell's north wall and its west wall.
+// a cell's south/east walls are the north/west walls of the neighbouring cell, so every interior wall
+// is only stored once. one extra row and column at the end hold the south and east border walls.
+// both planes of a row sit next to each other in a single allocation: [north words][west words]
+typedef struct {
+    int rows;             // maze size in cells (z axis)
+    int cols;             // maze size in cells (x axis)
+    int words_per_plane;  // 64 bit words per row in one bitplane
+    uint64_t *bits;
+    void *mapping;        // set when bits point into a memory mapped maze file (maze_file.c)
+    size_t mapping_bytes;
+} Maze;
+
+//directions, same numbering the player and solvers use
+#define NORTH 0
+#define EAST 1
+#define SOUTH 2
+#define WEST 3
+
+// a rectangle of cells still waiting to be split by the recursive division generators
+typedef struct {
+    int row_start, row_end;
+    int col_start, col_end;
+} Chamber;
+
+// chambers with fewer cells than this are finished by the thread that split their parent
+#define PARALLEL_CHAMBER_CUTOFF 4096
+
+//allocation and setup
+void allocate_maze(Maze *m, int rows, int cols);
+void free_maze(Maze *m);
+void init_maze(Maze *m);
+size_t maze_bytes(const Maze *m);
+
+//generation
+long generate_maze(Maze *m, Rng *rng, int row_start, int row_end, int col_start, int col_end);
+long generate_maze_iterative(Maze *m, Rng *rng, int row_start, int row_end, int col_start, int col_end);
+long make_maze(Maze *m, int rows, int cols, Rng *rng);
+Rng chamber_rng(uint64_t seed, const Chamber *c);
+void divide_chamber(Maze *m, const Chamber *chamber, Rng *rng, bool shared,
+                    int *divide_row_out, int *divide_col_out);
+
+//parallel generation (maze_parallel.c), same seed gives the same maze for any thread count
+long generate_maze_parallel(Maze *m, uint64_t seed, int num_threads);
+long make_maze_parallel(Maze *m, int rows, int cols, uint64_t seed, int num_threads);
+
+//streaming generation (maze_eller.c). rows are handed to a MazeRowFn as soon as they are done and
+//only O(cols) memory is used, so mazes far bigger than RAM can go straight to a file
+//(exporter_row in maze_export.h, maze_file_row in maze_file.h).
+//row == rows is the south border row, its west plane is all zero
+typedef void (*MazeRowFn)(void *user, int row, const uint64_t *north, const uint64_t *west, int cols);
+long generate_maze_eller(int rows, int cols, Rng *rng, MazeRowFn emit, void *user);
+long make_maze_eller(Maze *m, int rows, int cols, Rng *rng);
+
+//knock down percent of the inner walls, the maze gets loops (maze.c)
+long maze_add_loops(Maze *m, Rng *rng, int percent);
+
+//debug output
+void print_maze(const Maze *m);
+
+//accessors, these are in the header so they inline into the solvers and mesh builder
+static inline uint64_t *maze_north_row(const Maze *m, int row) {
+    return m->bits + (size_t)row * 2 * m->words_per_plane;
+}
+
+static inline uint64_t *maze_west_row(const Maze *m, int row) {
+    return maze_north_row(m, row) + m->words_per_plane;
+}
+
+static inline bool maze_get_bit(const uint64_t *plane, int col) {
+    return (plane[col >> 6] >> (col & 63)) & 1;
+}
+
+static inline void maze_put_bit(uint64_t *plane, int col, bool value) {
+    uint64_t mask = (uint64_t)1 << (col & 63);
+    if (value) plane[col >> 6] |= mask;
+    else plane[col >> 6] &= ~mask;
+}
+
+// true if the cell at (row, col) has a wall on the given side
+static inline bool maze_has_wall(const Maze *m, int row, int col, int direction) {
+    switch (direction) {
+        case NORTH: return maze_get_bit(maze_north_row(m, row), col);
+        case EAST:  return maze_get_bit(maze_west_row(m, row), col + 1);
+        case SOUTH: return maze_get_bit(maze_north_row(m, row + 1), col);
+        default:    return maze_get_bit(maze_west_row(m, row), col);
+    }
+}
+
+// add or remove the wall on the given side of (row, col), this also changes the neighbour's wall
+static inline void maze_set_wall(Maze *m, int row, int col, int direction, bool wall) {
+    switch (direction) {
+        case NORTH: maze_put_bit(maze_north_row(m, row), col, wall); break;
+        case EAST:  maze_put_bit(maze_west_row(m, row), col + 1, wall); break;
+        case SOUTH: maze_put_bit(maze_north_row(m, row + 1), col, wall); break;
+        default:    maze_put_bit(maze_west_row(m, row), col, wall); break;
+    }
+}
+
+// flip the wall on the given side of (row, col), returns true if there is a wall there now
+static inline bool maze_toggle_wall(Maze *m, int row, int col, int direction) {
+    bool wall = !maze_has_wall(m, row, col, direction);
+    maze_set_wall(m, row, col, direction, wall);
+    return wall;
+}
+
+#endif
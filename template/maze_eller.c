@@ -0,0 +1,160 @@
+#include "maze.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// row streaming generator using eller's algorithm. only the current row's sets and wall bits are kept,
+// so memory is O(cols) no matter how many rows the maze has. every finished row is handed to a
+// MazeRowFn in the same [north words][west words] layout a Maze row uses, followed by one last
+// row (row == rows) holding the south border, exactly like the extra row at the end of a Maze
+
+typedef struct {
+    int words_per_plane;
+    int *set;        // set label of every cell in the current row
+    int *parent;     // union-find over labels, labels are always < cols
+    int *count;      // cells of each set left to visit in the vertical pass
+    bool *opened;    // set already has a passage down
+    bool *used;      // label carried into the next row
+    int *free_labels;
+    uint64_t *bits;  // north plane then west plane of the row being built
+    uint32_t coin_bits;
+    int coins_left;
+} EllerRow;
+
+static int find_set(int *parent, int label) {
+    while (parent[label] != label) {
+        parent[label] = parent[parent[label]];
+        label = parent[label];
+    }
+    return label;
+}
+
+// one random bit, pulled 32 at a time so the inner loops arent dominated by the rng
+static inline bool coin(EllerRow *e, Rng *rng) {
+    if (e->coins_left == 0) {
+        e->coin_bits = rng_next(rng);
+        e->coins_left = 32;
+    }
+    bool bit = e->coin_bits & 1;
+    e->coin_bits >>= 1;
+    e->coins_left--;
+    return bit;
+}
+
+static void *eller_alloc(size_t count, size_t size) {
+    void *p = calloc(count, size);
+    if (!p) {
+        fprintf(stderr, "Failed to allocate memory for eller generator.\n");
+        exit(EXIT_FAILURE);
+    }
+    return p;
+}
+
+//generate a rows x cols maze one row at a time, returns the number of passages carved
+//(rows * cols - 1 for a finished maze since eller's makes a perfect maze)
+long generate_maze_eller(int rows, int cols, Rng *rng, MazeRowFn emit, void *user) {
+    if (rows < 1 || cols < 1) {
+        return 0;
+    }
+
+    EllerRow e;
+    memset(&e, 0, sizeof(e));
+    e.words_per_plane = (cols + 1 + 63) / 64; // same width as a Maze row
+    e.set = (int *)eller_alloc(cols, sizeof(int));
+    e.parent = (int *)eller_alloc(cols, sizeof(int));
+    e.count = (int *)eller_alloc(cols, sizeof(int));
+    e.opened = (bool *)eller_alloc(cols, sizeof(bool));
+    e.used = (bool *)eller_alloc(cols, sizeof(bool));
+    e.free_labels = (int *)eller_alloc(cols, sizeof(int));
+    e.bits = (uint64_t *)eller_alloc((size_t)2 * e.words_per_plane, sizeof(uint64_t));
+    uint64_t *north = e.bits;
+    uint64_t *west = e.bits + e.words_per_plane;
+
+    // first row, every cell in its own set and the north border closed except the exit
+    for (int c = 0; c < cols; c++) {
+        e.set[c] = c;
+        maze_put_bit(north, c, c != cols - 1);
+    }
+
+    long passages = 0;
+    for (int r = 0; r < rows; r++) {
+        bool last_row = (r == rows - 1);
+        for (int c = 0; c < cols; c++) e.parent[c] = c;
+
+        // horizontal pass, randomly join neighbours from different sets. the last row joins all of them
+        // so everything ends up connected
+        memset(west, 0, sizeof(uint64_t) * e.words_per_plane);
+        maze_put_bit(west, 0, true);
+        maze_put_bit(west, cols, true);
+        int current = find_set(e.parent, e.set[0]); // root of the cell left of the wall
+        for (int c = 0; c + 1 < cols; c++) {
+            int next = find_set(e.parent, e.set[c + 1]);
+            if (current != next && (last_row || coin(&e, rng))) {
+                e.parent[next] = current;
+                passages++;
+            } else {
+                maze_put_bit(west, c + 1, true);
+                current = next;
+            }
+        }
+        for (int c = 0; c < cols; c++) e.set[c] = find_set(e.parent, e.set[c]);
+
+        emit(user, r, north, west, cols);
+        if (last_row) break;
+
+        // vertical pass, every set needs at least one passage down or it would be cut off.
+        // the last cell of a set that hasnt opened yet is forced open
+        memset(e.count, 0, sizeof(int) * (size_t)cols);
+        memset(e.opened, 0, sizeof(bool) * (size_t)cols);
+        memset(e.used, 0, sizeof(bool) * (size_t)cols);
+        for (int c = 0; c < cols; c++) e.count[e.set[c]]++;
+
+        for (int c = 0; c < cols; c++) {
+            int s = e.set[c];
+            e.count[s]--;
+            bool down = coin(&e, rng) || (e.count[s] == 0 && !e.opened[s]);
+            maze_put_bit(north, c, !down); // becomes the next row's north plane
+            if (down) {
+                e.opened[s] = true;
+                e.used[s] = true;
+                passages++;
+            }
+        }
+
+        // cells under a wall start the next row in a brand new set
+        int num_free = 0;
+        for (int label = 0; label < cols; label++) {
+            if (!e.used[label]) e.free_labels[num_free++] = label;
+        }
+        for (int c = 0; c < cols; c++) {
+            if (maze_get_bit(north, c)) e.set[c] = e.free_labels[--num_free];
+        }
+    }
+
+    // south border, open under the entrance
+    memset(e.bits, 0, sizeof(uint64_t) * 2 * e.words_per_plane);
+    for (int c = 1; c < cols; c++) maze_put_bit(north, c, true);
+    emit(user, rows, north, west, cols);
+
+    free(e.set);
+    free(e.parent);
+    free(e.count);
+    free(e.opened);
+    free(e.used);
+    free(e.free_labels);
+    free(e.bits);
+    return passages;
+}
+
+// row sink that copies into a Maze allocated with the same size
+static void copy_row(void *user, int row, const uint64_t *north, const uint64_t *west, int cols) {
+    Maze *m = (Maze *)user;
+    memcpy(maze_north_row(m, row), north, sizeof(uint64_t) * m->words_per_plane);
+    memcpy(maze_west_row(m, row), west, sizeof(uint64_t) * m->words_per_plane);
+}
+
+// eller's into a normal in-memory maze, for when the maze is small enough to keep
+long make_maze_eller(Maze *m, int rows, int cols, Rng *rng) {
+    allocate_maze(m, rows, cols);
+    return generate_maze_eller(rows, cols, rng, copy_row, m);
+}
@@ -0,0 +1,213 @@
+#include "maze_export.h"
+#include <stdlib.h>
+#include <string.h>
+
+// one pbm byte covers 8 pixels = 4 cells. these turn 4 wall bits (lowest bit = leftmost cell) into
+// that byte, msb first. top lines alternate corner, north wall and the cell lines alternate west wall, floor
+static uint8_t pbm_top[16];
+static uint8_t pbm_middle[16];
+
+static void init_pbm_tables(void) {
+    for (int nibble = 0; nibble < 16; nibble++) {
+        uint8_t top = 0, middle = 0;
+        for (int j = 0; j < 4; j++) {
+            int wall = (nibble >> j) & 1;
+            top |= (uint8_t)((1 << (7 - 2 * j)) | (wall << (6 - 2 * j)));
+            middle |= (uint8_t)(wall << (7 - 2 * j));
+        }
+        pbm_top[nibble] = top;
+        pbm_middle[nibble] = middle;
+    }
+}
+
+int export_format_from_name(const char *name) {
+    if (strcmp(name, "ascii") == 0 || strcmp(name, "txt") == 0) return EXPORT_ASCII;
+    if (strcmp(name, "pbm") == 0) return EXPORT_PBM;
+    if (strcmp(name, "svg") == 0) return EXPORT_SVG;
+    return -1;
+}
+
+// picks the format from the extension, anything unknown is ascii
+int export_format_from_filename(const char *filename) {
+    const char *dot = strrchr(filename, '.');
+    int format = dot ? export_format_from_name(dot + 1) : -1;
+    return format < 0 ? EXPORT_ASCII : format;
+}
+
+static void flush_buffer(MazeExporter *e) {
+    if (e->used > 0 && fwrite(e->buffer, 1, e->used, e->out) != e->used) {
+        e->failed = true;
+    }
+    e->used = 0;
+}
+
+// make sure n more bytes fit, writing out what is already there first
+static char *reserve(MazeExporter *e, size_t n) {
+    if (e->used + n > e->capacity) {
+        flush_buffer(e);
+        if (n > e->capacity) {
+            e->capacity = n;
+            e->buffer = (char *)realloc(e->buffer, e->capacity);
+            if (!e->buffer) {
+                fprintf(stderr, "Failed to reallocate memory for export buffer.\n");
+                exit(EXIT_FAILURE);
+            }
+        }
+    }
+    return e->buffer + e->used;
+}
+
+static void append(MazeExporter *e, const char *text, size_t n) {
+    memcpy(reserve(e, n), text, n);
+    e->used += n;
+}
+
+void exporter_open(MazeExporter *e, FILE *out, int format, int rows, int cols) {
+    e->out = out;
+    e->format = format;
+    e->rows = rows;
+    e->cols = cols;
+    e->used = 0;
+    e->capacity = EXPORT_BUFFER_BYTES;
+    e->failed = false;
+    e->buffer = (char *)malloc(e->capacity);
+    if (!e->buffer) {
+        fprintf(stderr, "Failed to allocate memory for export buffer.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    char header[256];
+    int n = 0;
+    if (format == EXPORT_PBM) {
+        init_pbm_tables();
+        n = snprintf(header, sizeof(header), "P4\n%d %d\n", 2 * cols + 1, 2 * rows + 1);
+    } else if (format == EXPORT_SVG) {
+        n = snprintf(header, sizeof(header),
+                     "<svg xmlns=\"http://www.w3.org/2000/svg\" viewBox=\"-1 -1 %d %d\">\n"
+                     "<g stroke=\"black\" stroke-width=\"0.2\" stroke-linecap=\"square\" fill=\"none\">\n",
+                     cols + 2, rows + 2);
+    }
+    append(e, header, (size_t)n);
+}
+
+static void ascii_row(MazeExporter *e, const uint64_t *north, const uint64_t *west, int cols) {
+    char *p = reserve(e, (size_t)cols * 8 + 4);
+    for (int j = 0; j < cols; j++, p += 4) {
+        memcpy(p, maze_get_bit(north, j) ? "+---" : "+   ", 4);
+    }
+    *p++ = '+';
+    *p++ = '\n';
+
+    // the south border row has no east wall bit, it only gets the bottom line
+    if (maze_get_bit(west, cols)) {
+        for (int j = 0; j < cols; j++, p += 4) {
+            memcpy(p, maze_get_bit(west, j) ? "|   " : "    ", 4);
+        }
+        *p++ = '|';
+        *p++ = '\n';
+    }
+    e->used = (size_t)(p - e->buffer);
+}
+
+// one pixel line of the bitmap, 4 cells per output byte straight from the wall words
+static void pbm_line(MazeExporter *e, const uint64_t *plane, const uint8_t *table, int cols) {
+    size_t line_bytes = (size_t)(2 * cols + 1 + 7) / 8;
+    uint8_t *p = (uint8_t *)reserve(e, line_bytes);
+    for (size_t k = 0; k < line_bytes; k++) {
+        int cell = (int)k * 4;
+        p[k] = table[(plane[cell >> 6] >> (cell & 63)) & 0xF];
+    }
+    // the unused bits after the last pixel have to be 0
+    int spare = (int)(line_bytes * 8) - (2 * cols + 1);
+    p[line_bytes - 1] &= (uint8_t)(0xFF << spare);
+    e->used += line_bytes;
+}
+
+static void pbm_row(MazeExporter *e, const uint64_t *north, const uint64_t *west, int cols) {
+    pbm_line(e, north, pbm_top, cols);
+    if (maze_get_bit(west, cols)) pbm_line(e, west, pbm_middle, cols);
+}
+
+// sprintf is most of the svg time, the numbers are never negative so this is all thats needed
+static char *put_int(char *p, int value) {
+    char digits[12];
+    int n = 0;
+    do {
+        digits[n++] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value > 0);
+    while (n > 0) *p++ = digits[--n];
+    return p;
+}
+
+// one "M x y" command followed by an h or v line of the given length
+static char *put_line(char *p, int x, int y, char direction, int length) {
+    *p++ = 'M';
+    p = put_int(p, x);
+    *p++ = ' ';
+    p = put_int(p, y);
+    *p++ = direction;
+    return put_int(p, length);
+}
+
+// horizontal walls are merged into runs, vertical ones are one unit each
+static void svg_row(MazeExporter *e, int row, const uint64_t *north, const uint64_t *west, int cols) {
+    bool border = !maze_get_bit(west, cols);
+    char *p = reserve(e, (size_t)(cols + 1) * 64 + 64); // worst case, alternating walls
+    memcpy(p, "<path d=\"", 9);
+    p += 9;
+    for (int j = 0; j < cols; j++) {
+        if (!maze_get_bit(north, j)) continue;
+        int run = j;
+        while (run + 1 < cols && maze_get_bit(north, run + 1)) run++;
+        p = put_line(p, j, row, 'h', run - j + 1);
+        j = run;
+    }
+    if (!border) {
+        for (int j = 0; j <= cols; j++) {
+            if (maze_get_bit(west, j)) p = put_line(p, j, row, 'v', 1);
+        }
+    }
+    memcpy(p, "\"/>\n", 4);
+    p += 4;
+    e->used = (size_t)(p - e->buffer);
+}
+
+// MazeRowFn, user is the MazeExporter
+void exporter_row(void *user, int row, const uint64_t *north, const uint64_t *west, int cols) {
+    MazeExporter *e = (MazeExporter *)user;
+    if (e->format == EXPORT_PBM) pbm_row(e, north, west, cols);
+    else if (e->format == EXPORT_SVG) svg_row(e, row, north, west, cols);
+    else ascii_row(e, north, west, cols);
+}
+
+// writes whatever is left, returns false if any write failed
+bool exporter_close(MazeExporter *e) {
+    if (e->format == EXPORT_SVG) append(e, "</g>\n</svg>\n", 12);
+    flush_buffer(e);
+    if (fflush(e->out) != 0) e->failed = true;
+    free(e->buffer);
+    e->buffer = NULL;
+    return !e->failed;
+}
+
+bool export_maze(const Maze *m, FILE *out, int format) {
+    MazeExporter e;
+    exporter_open(&e, out, format, m->rows, m->cols);
+    for (int row = 0; row <= m->rows; row++) {
+        exporter_row(&e, row, maze_north_row(m, row), maze_west_row(m, row), m->cols);
+    }
+    return exporter_close(&e);
+}
+
+bool export_maze_file(const Maze *m, const char *filename, int format) {
+    FILE *out = fopen(filename, "wb");
+    if (!out) {
+        perror(filename);
+        return false;
+    }
+    bool ok = export_maze(m, out, format);
+    if (fclose(out) != 0) ok = false;
+    if (!ok) fprintf(stderr, "Failed to write %s.\n", filename);
+    return ok;
+}
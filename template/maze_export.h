@@ -0,0 +1,42 @@
+#ifndef _MAZE_EXPORT_H_
+#define _MAZE_EXPORT_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "maze.h"
+
+// image/text exporters. rows are rendered into one big reusable buffer that only gets written out
+// when it fills up, so even multi-million cell mazes go out in a handful of fwrite calls.
+// the exporter is also a MazeRowFn so eller's generator can stream straight into it
+enum {
+    EXPORT_ASCII,  // same text as print_maze
+    EXPORT_PBM,    // binary P4 bitmap, 2 * cols + 1 by 2 * rows + 1 pixels, walls are black
+    EXPORT_SVG,    // one path per maze row, one unit per cell
+};
+
+#define EXPORT_BUFFER_BYTES (1 << 20)
+
+typedef struct {
+    FILE *out;
+    int format;
+    int rows, cols;
+    char *buffer;
+    size_t used, capacity;
+    bool failed;          // a write went wrong, reported by exporter_close
+} MazeExporter;
+
+int export_format_from_name(const char *name);
+int export_format_from_filename(const char *filename);
+
+//streaming, rows must arrive in order including the border row (row == rows)
+void exporter_open(MazeExporter *e, FILE *out, int format, int rows, int cols);
+void exporter_row(void *user, int row, const uint64_t *north, const uint64_t *west, int cols);
+bool exporter_close(MazeExporter *e);
+
+//whole maze at once
+bool export_maze(const Maze *m, FILE *out, int format);
+bool export_maze_file(const Maze *m, const char *filename, int format);
+
+#endif
@@ -0,0 +1,151 @@
+#include "maze_file.h"
+#include <stdlib.h>
+#include <string.h>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+_Static_assert(sizeof(MazeFileHeader) == 64, "maze file header must stay 64 bytes");
+
+static size_t data_bytes_for(int rows, int cols) {
+    int words_per_plane = (cols + 1 + 63) / 64;
+    return (size_t)(rows + 1) * 2 * words_per_plane * sizeof(uint64_t);
+}
+
+void maze_file_header(MazeFileHeader *h, int rows, int cols, uint64_t seed, uint32_t generator) {
+    memset(h, 0, sizeof(*h));
+    memcpy(h->magic, MAZE_FILE_MAGIC, sizeof(h->magic));
+    h->version = MAZE_FILE_VERSION;
+    h->byte_order = MAZE_FILE_BYTE_ORDER;
+    h->seed = seed;
+    h->generator = generator;
+    h->rows = rows;
+    h->cols = cols;
+    h->words_per_plane = (cols + 1 + 63) / 64;
+    h->header_bytes = sizeof(MazeFileHeader);
+    h->data_bytes = data_bytes_for(rows, cols);
+}
+
+bool maze_file_write_header(FILE *out, const MazeFileHeader *h) {
+    return fwrite(h, sizeof(*h), 1, out) == 1;
+}
+
+// MazeRowFn that appends the row's words to the FILE in user, the border row included
+void maze_file_row(void *user, int row, const uint64_t *north, const uint64_t *west, int cols) {
+    FILE *out = (FILE *)user;
+    size_t words = (size_t)(cols + 1 + 63) / 64;
+    fwrite(north, sizeof(uint64_t), words, out);
+    fwrite(west, sizeof(uint64_t), words, out);
+}
+
+// the walls are already laid out the way the file wants them so this is one big write
+bool maze_save(const Maze *m, const char *filename, uint64_t seed, uint32_t generator) {
+    FILE *out = fopen(filename, "wb");
+    if (!out) {
+        perror(filename);
+        return false;
+    }
+    MazeFileHeader h;
+    maze_file_header(&h, m->rows, m->cols, seed, generator);
+    bool ok = maze_file_write_header(out, &h) && fwrite(m->bits, 1, maze_bytes(m), out) == maze_bytes(m);
+    if (fclose(out) != 0) ok = false;
+    if (!ok) fprintf(stderr, "Failed to write maze file %s.\n", filename);
+    return ok;
+}
+
+static bool check_header(const MazeFileHeader *h, size_t file_bytes, const char *filename) {
+    const char *problem = NULL;
+    if (memcmp(h->magic, MAZE_FILE_MAGIC, sizeof(h->magic)) != 0) problem = "not a maze file";
+    else if (h->byte_order != MAZE_FILE_BYTE_ORDER) problem = "written on a machine with a different byte order";
+    else if (h->version != MAZE_FILE_VERSION) problem = "unsupported version";
+    else if (h->rows <= 0 || h->cols <= 0 || h->words_per_plane != (h->cols + 1 + 63) / 64) problem = "bad size";
+    else if (h->header_bytes < sizeof(MazeFileHeader) || h->header_bytes % 8 != 0) problem = "bad header size";
+    else if (h->data_bytes != data_bytes_for(h->rows, h->cols)) problem = "bad data size";
+    else if (file_bytes < h->header_bytes + h->data_bytes) problem = "file is truncated";
+
+    if (problem) {
+        fprintf(stderr, "Cannot load maze file %s: %s.\n", filename, problem);
+        return false;
+    }
+    return true;
+}
+
+// load a maze saved by maze_save (or streamed with maze_file_row). on posix the file is mapped and the
+// maze uses the wall words in place, pages only get read when something touches them. the mapping is
+// private so changing walls later never writes back to the file. free_maze unmaps it
+bool maze_load(Maze *m, const char *filename, MazeFileHeader *header_out) {
+    MazeFileHeader h;
+#ifndef _WIN32
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        perror(filename);
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(h)) {
+        fprintf(stderr, "Cannot load maze file %s: file is truncated.\n", filename);
+        close(fd);
+        return false;
+    }
+    void *mapping = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd); // the mapping keeps its own reference
+    if (mapping == MAP_FAILED) {
+        perror(filename);
+        return false;
+    }
+    memcpy(&h, mapping, sizeof(h));
+    if (!check_header(&h, (size_t)st.st_size, filename)) {
+        munmap(mapping, (size_t)st.st_size);
+        return false;
+    }
+    m->bits = (uint64_t *)((char *)mapping + h.header_bytes);
+    m->mapping = mapping;
+    m->mapping_bytes = (size_t)st.st_size;
+#else
+    // no mmap here, read the words into a normal allocation instead
+    FILE *in = fopen(filename, "rb");
+    if (!in) {
+        perror(filename);
+        return false;
+    }
+    fseek(in, 0, SEEK_END);
+    long file_bytes = ftell(in);
+    fseek(in, 0, SEEK_SET);
+    if (file_bytes < (long)sizeof(h) || fread(&h, sizeof(h), 1, in) != 1 ||
+        !check_header(&h, (size_t)file_bytes, filename)) {
+        fclose(in);
+        return false;
+    }
+    m->bits = (uint64_t *)malloc(h.data_bytes);
+    if (!m->bits) {
+        fprintf(stderr, "Failed to allocate memory for maze.\n");
+        exit(EXIT_FAILURE);
+    }
+    fseek(in, h.header_bytes, SEEK_SET);
+    if (fread(m->bits, 1, h.data_bytes, in) != h.data_bytes) {
+        fprintf(stderr, "Cannot load maze file %s: file is truncated.\n", filename);
+        free(m->bits);
+        fclose(in);
+        return false;
+    }
+    fclose(in);
+    m->mapping = NULL;
+    m->mapping_bytes = 0;
+#endif
+    m->rows = h.rows;
+    m->cols = h.cols;
+    m->words_per_plane = h.words_per_plane;
+    if (header_out) *header_out = h;
+    return true;
+}
+
+void maze_file_unmap(Maze *m) {
+#ifndef _WIN32
+    if (m->mapping) munmap(m->mapping, m->mapping_bytes);
+#endif
+    m->mapping = NULL;
+    m->mapping_bytes = 0;
+}
@@ -0,0 +1,49 @@
+#ifndef _MAZE_FILE_H_
+#define _MAZE_FILE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "maze.h"
+
+// binary maze file: a fixed 64 byte header followed by the wall words exactly as they sit in
+// Maze.bits, so loading just maps the file and points the maze at the words after the header.
+// everything is stored in the machine's byte order, byte_order catches files from the other kind
+#define MAZE_FILE_MAGIC "MAZEBITS"
+#define MAZE_FILE_VERSION 1
+#define MAZE_FILE_BYTE_ORDER 0x01020304u
+
+// which generator made the maze, same seed + generator gives the same walls
+enum {
+    MAZE_GEN_UNKNOWN = 0,
+    MAZE_GEN_DIVISION = 1,           // make_maze
+    MAZE_GEN_DIVISION_PARALLEL = 2,  // make_maze_parallel (per chamber streams)
+    MAZE_GEN_ELLER = 3,              // generate_maze_eller
+};
+
+typedef struct {
+    char magic[8];            // MAZE_FILE_MAGIC, not nul terminated
+    uint32_t version;
+    uint32_t byte_order;
+    uint64_t seed;
+    uint32_t generator;       // MAZE_GEN_*
+    int32_t rows;
+    int32_t cols;
+    int32_t words_per_plane;
+    uint32_t header_bytes;    // offset of the wall words, keeps them 8 byte aligned
+    uint32_t reserved;
+    uint64_t data_bytes;      // (rows + 1) * 2 * words_per_plane * 8
+    uint8_t padding[8];
+} MazeFileHeader;
+
+//whole maze at once
+bool maze_save(const Maze *m, const char *filename, uint64_t seed, uint32_t generator);
+bool maze_load(Maze *m, const char *filename, MazeFileHeader *header_out);
+void maze_file_unmap(Maze *m);
+
+//streaming, write the header then hand maze_file_row to generate_maze_eller with the FILE as user
+void maze_file_header(MazeFileHeader *h, int rows, int cols, uint64_t seed, uint32_t generator);
+bool maze_file_write_header(FILE *out, const MazeFileHeader *h);
+void maze_file_row(void *user, int row, const uint64_t *north, const uint64_t *west, int cols);
+
+#endif
@@ -0,0 +1,230 @@
+#include "maze.h"
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// multi-threaded recursive division. after a split the four sub chambers only touch their own cells,
+// so big chambers get handed to a small work stealing pool. every chamber draws from its own stream
+// (chamber_rng) so the maze comes out byte identical no matter how many threads there are
+
+// chamber deque for one worker. the owner pushes/pops at the back, other workers steal from the front
+typedef struct {
+    pthread_mutex_t lock;
+    Chamber *items;
+    int head;      // next item to steal
+    int tail;      // one past the last item
+    int capacity;
+} ChamberDeque;
+
+typedef struct {
+    Maze *maze;
+    uint64_t seed;
+    int num_threads;
+    ChamberDeque *deques;
+    long pending;  // chambers queued or being split, the pool is done when this hits 0
+} ParallelGen;
+
+typedef struct {
+    ParallelGen *gen;
+    int id;
+    long chambers;
+} Worker;
+
+static long chamber_area(const Chamber *c) {
+    return (long)(c->row_end - c->row_start + 1) * (c->col_end - c->col_start + 1);
+}
+
+static bool chamber_too_small(const Chamber *c) {
+    return c->row_end - c->row_start < 1 || c->col_end - c->col_start < 1;
+}
+
+static void deque_push(ChamberDeque *d, Chamber c) {
+    pthread_mutex_lock(&d->lock);
+    if (d->tail == d->capacity) {
+        // slide everything back to the front before growing
+        int count = d->tail - d->head;
+        if (d->head > 0) {
+            for (int i = 0; i < count; i++) d->items[i] = d->items[d->head + i];
+            d->head = 0;
+            d->tail = count;
+        }
+        if (d->tail == d->capacity) {
+            d->capacity *= 2;
+            d->items = (Chamber *)realloc(d->items, sizeof(Chamber) * d->capacity);
+            if (!d->items) {
+                fprintf(stderr, "Failed to reallocate memory for chamber deque.\n");
+                exit(EXIT_FAILURE);
+            }
+        }
+    }
+    d->items[d->tail++] = c;
+    pthread_mutex_unlock(&d->lock);
+}
+
+static bool deque_pop(ChamberDeque *d, Chamber *out) {
+    bool found = false;
+    pthread_mutex_lock(&d->lock);
+    if (d->tail > d->head) {
+        *out = d->items[--d->tail];
+        found = true;
+    }
+    pthread_mutex_unlock(&d->lock);
+    return found;
+}
+
+static bool deque_steal(ChamberDeque *d, Chamber *out) {
+    bool found = false;
+    pthread_mutex_lock(&d->lock);
+    if (d->tail > d->head) {
+        *out = d->items[d->head++];
+        found = true;
+    }
+    pthread_mutex_unlock(&d->lock);
+    return found;
+}
+
+// split a chamber and everything under it on this thread
+static long finish_chamber(Maze *m, uint64_t seed, Chamber root, bool shared) {
+    int capacity = 64;
+    int top = 0;
+    Chamber *stack = (Chamber *)malloc(sizeof(Chamber) * capacity);
+    if (!stack) {
+        fprintf(stderr, "Failed to allocate memory for generator stack.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    long chambers = 0;
+    stack[top++] = root;
+
+    while (top > 0) {
+        Chamber c = stack[--top];
+        if (chamber_too_small(&c)) {
+            continue;
+        }
+
+        int divide_row, divide_col;
+        Rng rng = chamber_rng(seed, &c);
+        divide_chamber(m, &c, &rng, shared, &divide_row, &divide_col);
+        chambers++;
+
+        if (top + 4 > capacity) {
+            capacity *= 2;
+            stack = (Chamber *)realloc(stack, sizeof(Chamber) * capacity);
+            if (!stack) {
+                fprintf(stderr, "Failed to reallocate memory for generator stack.\n");
+                exit(EXIT_FAILURE);
+            }
+        }
+        stack[top++] = (Chamber){divide_row, c.row_end, divide_col, c.col_end};
+        stack[top++] = (Chamber){divide_row, c.row_end, c.col_start, divide_col - 1};
+        stack[top++] = (Chamber){c.row_start, divide_row - 1, divide_col, c.col_end};
+        stack[top++] = (Chamber){c.row_start, divide_row - 1, c.col_start, divide_col - 1};
+    }
+
+    free(stack);
+    return chambers;
+}
+
+static void *worker_main(void *arg) {
+    Worker *w = (Worker *)arg;
+    ParallelGen *gen = w->gen;
+    ChamberDeque *own = &gen->deques[w->id];
+
+    while (__atomic_load_n(&gen->pending, __ATOMIC_ACQUIRE) > 0) {
+        Chamber c;
+        bool found = deque_pop(own, &c);
+
+        // nothing left locally, go steal from the others
+        for (int i = 1; !found && i < gen->num_threads; i++) {
+            found = deque_steal(&gen->deques[(w->id + i) % gen->num_threads], &c);
+        }
+        if (!found) {
+            sched_yield();
+            continue;
+        }
+
+        if (chamber_area(&c) < PARALLEL_CHAMBER_CUTOFF) {
+            w->chambers += finish_chamber(gen->maze, gen->seed, c, true);
+        } else if (!chamber_too_small(&c)) {
+            int divide_row, divide_col;
+            Rng rng = chamber_rng(gen->seed, &c);
+            divide_chamber(gen->maze, &c, &rng, true, &divide_row, &divide_col);
+            w->chambers++;
+
+            // count the children before they are visible so pending never drops to 0 early
+            __atomic_add_fetch(&gen->pending, 4, __ATOMIC_RELEASE);
+            deque_push(own, (Chamber){divide_row, c.row_end, divide_col, c.col_end});
+            deque_push(own, (Chamber){divide_row, c.row_end, c.col_start, divide_col - 1});
+            deque_push(own, (Chamber){c.row_start, divide_row - 1, divide_col, c.col_end});
+            deque_push(own, (Chamber){c.row_start, divide_row - 1, c.col_start, divide_col - 1});
+        }
+        __atomic_sub_fetch(&gen->pending, 1, __ATOMIC_RELEASE);
+    }
+    return NULL;
+}
+
+//generate the whole maze with num_threads workers, returns the number of chambers split
+long generate_maze_parallel(Maze *m, uint64_t seed, int num_threads) {
+    Chamber root = {0, m->rows - 1, 0, m->cols - 1};
+
+    // one thread (or a tiny maze) doesnt need the pool, and gives the same walls anyway
+    if (num_threads <= 1 || chamber_area(&root) < PARALLEL_CHAMBER_CUTOFF) {
+        return finish_chamber(m, seed, root, false);
+    }
+
+    ParallelGen gen = {m, seed, num_threads, NULL, 1};
+    gen.deques = (ChamberDeque *)malloc(sizeof(ChamberDeque) * num_threads);
+    Worker *workers = (Worker *)malloc(sizeof(Worker) * num_threads);
+    pthread_t *threads = (pthread_t *)malloc(sizeof(pthread_t) * num_threads);
+    if (!gen.deques || !workers || !threads) {
+        fprintf(stderr, "Failed to allocate memory for generator threads.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (int i = 0; i < num_threads; i++) {
+        ChamberDeque *d = &gen.deques[i];
+        pthread_mutex_init(&d->lock, NULL);
+        d->capacity = 64;
+        d->head = 0;
+        d->tail = 0;
+        d->items = (Chamber *)malloc(sizeof(Chamber) * d->capacity);
+        if (!d->items) {
+            fprintf(stderr, "Failed to allocate memory for chamber deque.\n");
+            exit(EXIT_FAILURE);
+        }
+        workers[i] = (Worker){&gen, i, 0};
+    }
+    deque_push(&gen.deques[0], root);
+
+    for (int i = 0; i < num_threads; i++) {
+        if (pthread_create(&threads[i], NULL, worker_main, &workers[i]) != 0) {
+            fprintf(stderr, "Failed to start generator thread.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    for (int i = 0; i < num_threads; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    // other workers can still be stealing until everyone is joined, so tear down after
+    long chambers = 0;
+    for (int i = 0; i < num_threads; i++) {
+        chambers += workers[i].chambers;
+        pthread_mutex_destroy(&gen.deques[i].lock);
+        free(gen.deques[i].items);
+    }
+
+    free(gen.deques);
+    free(workers);
+    free(threads);
+    return chambers;
+}
+
+// same as make_maze but with the parallel generator
+long make_maze_parallel(Maze *m, int rows, int cols, uint64_t seed, int num_threads) {
+    allocate_maze(m, rows, cols);
+    init_maze(m);
+    return generate_maze_parallel(m, seed, num_threads);
+}
@@ -0,0 +1,492 @@
+#include "mesh.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//cube global variables
+float scale_cube = 1.00f;
+int num_vertices_per_block = 36;
+int num_vertices = 0;
+
+//array global variable
+vec4 *positions = NULL;
+vec2 *tex_coords = NULL;
+vec4 *block_positions = NULL; // Store positions for a single block
+vec2 *block_tex_coords = NULL;
+
+// where each wall edge's blocks are in positions, so one wall can be rewritten without touching the rest.
+// edge (i, j, west) is (i * (cols + 1) + j) * 2 + west, wall_first is -1 for an edge with no blocks.
+// the spare slots after the walls are empty (all zero, nothing gets drawn) until mesh_set_wall puts up a
+// wall that had no blocks of its own. spare_free is a stack of the slots not in use, a wall in a spare slot
+// gives it back when it comes down again
+static int *wall_first = NULL;
+static int *wall_count = NULL;
+static int wall_cols = 0;
+static int spare_first = 0;
+static int spare_slots = 0;
+static int *spare_free = NULL;
+static int spare_free_count = 0;
+
+void init_block(){
+    if (block_positions == NULL) {
+        block_positions = (vec4 *) malloc(sizeof(vec4) * num_vertices_per_block);
+        if (block_positions == NULL) {
+            fprintf(stderr, "Failed to allocate memory for block_positions.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    
+    if (block_tex_coords == NULL) {
+        block_tex_coords = (vec2 *) malloc(sizeof(vec2) * num_vertices_per_block);
+        if (block_tex_coords == NULL) {
+            fprintf(stderr, "Failed to allocate memory for block_tex_coords.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    block_positions[0] = (vec4) {.25, -.25,  0.0,  1.0}; 
+    block_positions[1] = (vec4) {-0.25,  0.25,  0.0,  1.0}; 
+    block_positions[2] = (vec4) {-0.25, -.25,  0.0,  1.0}; 
+    block_positions[3] = (vec4) {.25, -.25,  0.0,  1.0}; 
+    block_positions[4] = (vec4) { .25, 0.25,  0.0,  1.0}; 
+    block_positions[5] = (vec4) {-0.25,  0.25,  0.0,  1.0}; 
+
+    //ls 
+    block_positions[6] = (vec4) {.25, -.25,  -.5,  1.0}; 
+    block_positions[7] =  (vec4) {.25, .25,  0.0,  1.0}; 
+    block_positions[8] =  (vec4) {.25, -.25,  0.0,  1.0}; 
+    block_positions[9] = (vec4) {.25, -.25,  -.5,  1.0}; 
+    block_positions[10] =  (vec4) {.25, .25,  -.5,  1.0}; 
+    block_positions[11] =  (vec4) {.25, .25,  0.0,  1.0}; 
+
+    //rs 
+    block_positions[12] = (vec4) {-.25, -.25,  0,  1.0}; 
+    block_positions[13] =  (vec4) {-.25, .25,  0.0,  1.0}; 
+    block_positions[14] =  (vec4) {-.25, -.25,  -0.5,  1.0}; 
+    block_positions[15] = (vec4) {-.25, .25,  0,  1.0}; 
+    block_positions[16] =  (vec4) {-.25, .25,  -.5,  1.0}; 
+    block_positions[17] =  (vec4) {-.25, -.25,  -0.5,  1.0}; 
+
+    //bs 
+    block_positions[18] = (vec4) {-.25, -.25,  -.5,  1.0}; 
+    block_positions[19] =  (vec4) {-.25, .25,  -.5,  1.0}; 
+    block_positions[20] =  (vec4) {.25, -.25,  -0.5,  1.0}; 
+    block_positions[21] = (vec4) {-.25, .25,  -.5,  1.0}; 
+    block_positions[22] =  (vec4) {.25, .25,  -.5,  1.0}; 
+    block_positions[23] =  (vec4) {.25, -.25,  -.5,  1.0}; 
+
+    //top
+    block_positions[24] = (vec4) {.25, .25,  0,  1.0}; 
+    block_positions[25] =  (vec4) {.25, .25,  -.5,  1.0}; 
+    block_positions[26] =  (vec4) {-.25, .25,  -0,  1.0}; 
+    block_positions[27] = (vec4) {.25, .25,  -.5,  1.0}; 
+    block_positions[28] =  (vec4) {-.25, .25,  -.5,  1.0}; 
+    block_positions[29] =  (vec4) {-.25, .25,  0,  1.0}; 
+
+    //bottom
+    block_positions[30] = (vec4) {.25, -.25,  -.5,  1.0}; 
+    block_positions[31] =  (vec4) {.25, -.25,  0,  1.0}; 
+    block_positions[32] =  (vec4) {-.25, -.25,  -0.5,  1.0}; 
+    block_positions[33] = (vec4) {.25, -.25,  -0,  1.0}; 
+    block_positions[34] =  (vec4) {-.25, -.25,  -0,  1.0}; 
+    block_positions[35] =  (vec4) {-.25, -.25,  -.5,  1.0}; 
+
+    for (int i = 0; i < num_vertices_per_block; ++i) {
+        block_positions[i].x *= scale_cube;
+        block_positions[i].y *= scale_cube;
+        block_positions[i].z *= scale_cube;
+    }
+}
+
+void init_texture(float rcornerX, float rcornerY){
+    //front
+    block_tex_coords[0] = (vec2) {rcornerX, rcornerY};
+    block_tex_coords[1] = (vec2) {rcornerX - .25, rcornerY - .25};
+    block_tex_coords[2] = (vec2) {rcornerX - .25, rcornerY};
+    block_tex_coords[3] = (vec2) {rcornerX, rcornerY};
+    block_tex_coords[4] = (vec2) {rcornerX, rcornerY - .25};
+    block_tex_coords[5] = (vec2) {rcornerX - .25, rcornerY - .25};
+
+    //ls
+    block_tex_coords[6] = (vec2) {rcornerX, rcornerY};
+    block_tex_coords[7] = (vec2) {rcornerX - .25, rcornerY - .25};
+    block_tex_coords[8] = (vec2) {rcornerX - .25, rcornerY};
+    block_tex_coords[9] = (vec2) {rcornerX, rcornerY};
+    block_tex_coords[10] = (vec2) {rcornerX, rcornerY - .25};
+    block_tex_coords[11] = (vec2) {rcornerX - .25, rcornerY - .25};
+
+    //rs
+    block_tex_coords[12] = (vec2) {rcornerX, rcornerY};
+    block_tex_coords[13] = (vec2) {rcornerX, rcornerY - .25};
+    block_tex_coords[14] = (vec2) {rcornerX - .25, rcornerY};
+    block_tex_coords[15] = (vec2) {rcornerX, rcornerY - .25};
+    block_tex_coords[16] = (vec2) {rcornerX - .25, rcornerY - .25};
+    block_tex_coords[17] = (vec2) {rcornerX - .25, rcornerY};
+
+    //bs
+    block_tex_coords[18] = (vec2) {rcornerX, rcornerY};
+    block_tex_coords[19] = (vec2) {rcornerX, rcornerY - .25};
+    block_tex_coords[20] = (vec2) {rcornerX - .25, rcornerY};
+    block_tex_coords[21] = (vec2) {rcornerX, rcornerY - .25};
+    block_tex_coords[22] = (vec2) {rcornerX - .25, rcornerY - .25};
+    block_tex_coords[23] = (vec2) {rcornerX - .25, rcornerY};
+
+    //top
+    block_tex_coords[24] = (vec2) {rcornerX, rcornerY};
+    block_tex_coords[25] = (vec2) {rcornerX, rcornerY - .25};
+    block_tex_coords[26] = (vec2) {rcornerX - .25, rcornerY};
+    block_tex_coords[27] = (vec2) {rcornerX, rcornerY - .25};
+    block_tex_coords[28] = (vec2) {rcornerX - .25, rcornerY - .25};
+    block_tex_coords[29] = (vec2) {rcornerX - .25, rcornerY};
+
+    //bottom
+    block_tex_coords[30] = (vec2) {rcornerX, rcornerY};
+    block_tex_coords[31] = (vec2) {rcornerX, rcornerY - .25};
+    block_tex_coords[32] = (vec2) {rcornerX - .25, rcornerY};
+    block_tex_coords[33] = (vec2) {rcornerX, rcornerY - .25};
+    block_tex_coords[34] = (vec2) {rcornerX - .25, rcornerY - .25};
+    block_tex_coords[35] = (vec2) {rcornerX - .25, rcornerY};
+}
+
+//make the maze flooring
+void generate_maze_floor(int maze_x, int maze_z) {
+    //plank texture for floor
+    init_texture(1.0f, 0.75f);
+
+    // calculate floor dimensions
+    int floor_width = maze_x * 5 - (maze_x - 1);  // total blocks in x-axis
+    int floor_depth = maze_z * 5 - (maze_z - 1);  // total blocks in z-axis
+
+    // calculate total number of blocks and vertices
+    int floor_blocks = floor_width * floor_depth;
+    int floor_vertices = floor_blocks * num_vertices_per_block;
+
+    // allocate memory for positions and texture coords
+    vec4 *floor_positions = (vec4 *)malloc(sizeof(vec4) * floor_vertices);
+    vec2 *floor_tex_coords = (vec2 *)malloc(sizeof(vec2) * floor_vertices);
+    if (!floor_positions || !floor_tex_coords) {
+        fprintf(stderr, "Failed to allocate memory for maze floor.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    int index = 0;
+    float y_translation = scale_cube * 0.5f;
+    float block_size = scale_cube * 0.5f;
+
+    // calculate offsets to center the floor
+    float x_offset = -(floor_width / 2.0f) * block_size + block_size / 2.0f;
+    float z_offset = -(floor_depth / 2.0f) * block_size + block_size / 2.0f;
+
+    // loop through the maze dimensions and create the floor
+    for (int i = 0; i < floor_depth; ++i) {
+        for (int j = 0; j < floor_width; ++j) {
+            // calculate translation for the current block
+            float x_translation = j * block_size + x_offset;
+            float z_translation = i * block_size + z_offset;
+
+            // then copy block positions and apply translation
+            for (int k = 0; k < num_vertices_per_block; ++k) {
+                floor_positions[index] = block_positions[k];
+                floor_positions[index].x += x_translation;
+                floor_positions[index].y += y_translation;
+                floor_positions[index].z += z_translation;
+                floor_tex_coords[index] = block_tex_coords[k];
+                index++;
+            }
+        }
+    }
+
+    // update global positions and tex_coords with the new floor data
+    num_vertices += floor_vertices;
+    positions = (vec4 *)realloc(positions, sizeof(vec4) * num_vertices);
+    tex_coords = (vec2 *)realloc(tex_coords, sizeof(vec2) * num_vertices);
+
+    if (!positions || !tex_coords) {
+        fprintf(stderr, "Failed to reallocate memory for maze floor vertices.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    memcpy(positions + (num_vertices - floor_vertices), floor_positions, sizeof(vec4) * floor_vertices);
+    memcpy(tex_coords + (num_vertices - floor_vertices), floor_tex_coords, sizeof(vec2) * floor_vertices);
+
+    free(floor_positions);
+    free(floor_tex_coords);
+}
+
+//make the verts or poles
+void generate_maze_poles(int maze_x, int maze_z, Rng *rng) {
+    // cracked stone brick for poles
+    init_texture(0.5f, 0.5f);
+
+    // calculate amount of poles
+    int num_poles_x = maze_x + 1;
+    int num_poles_z = maze_z + 1;
+
+    // pole block size and base height
+    float block_size = scale_cube * 0.5f;
+    float base_height = scale_cube;
+
+    // calculate offsets to center the poles
+    float x_offset = -(maze_x * 5 - (maze_x - 1)) / 2.0f * block_size + block_size / 2.0f;
+    float z_offset = -(maze_z * 5 - (maze_z - 1)) / 2.0f * block_size + block_size / 2.0f;
+
+    // temporary lists to store pole vertices and texture coordinates
+    int max_pole_blocks = num_poles_x * num_poles_z * 5;  // max of 5 blocks per pole
+    int max_pole_vertices = max_pole_blocks * num_vertices_per_block;
+
+    vec4 *temp_positions = (vec4 *)malloc(sizeof(vec4) * max_pole_vertices);
+    vec2 *temp_tex_coords = (vec2 *)malloc(sizeof(vec2) * max_pole_vertices);
+
+    if (!temp_positions || !temp_tex_coords) {
+        fprintf(stderr, "Failed to allocate memory for maze poles.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    int index = 0;
+
+    // loop through poles along the grid
+    for (int i = 0; i < num_poles_z; ++i) {
+        for (int j = 0; j < num_poles_x; ++j) {
+            // find base position of pole
+            float x_pole = j * (5 * block_size - block_size) + x_offset;
+            float z_pole = i * (5 * block_size - block_size) + z_offset;
+
+            // randomize pole height between 3 and 5 blocks
+            int pole_height = rng_between(rng, 3, 6);  // 6 is exclusive here
+
+            // stack blocks vertically to build the pole
+            for (int h = 0; h < pole_height; ++h) {
+                // add a block at the current height
+                for (int k = 0; k < num_vertices_per_block; ++k) {
+                    temp_positions[index] = block_positions[k];
+                    temp_positions[index].x += x_pole;
+                    temp_positions[index].y += base_height + h * block_size;
+                    temp_positions[index].z += z_pole;
+
+                    temp_tex_coords[index] = block_tex_coords[k];
+                    index++;
+                }
+            }
+        }
+    }
+
+    // update global positions and tex_coords with the new pole data
+    int pole_vertices = index;  // total vertices used for poles
+
+    positions = (vec4 *)realloc(positions, sizeof(vec4) * (num_vertices + pole_vertices));
+    tex_coords = (vec2 *)realloc(tex_coords, sizeof(vec2) * (num_vertices + pole_vertices));
+
+    if (!positions || !tex_coords) {
+        fprintf(stderr, "Failed to reallocate memory for maze pole vertices.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    memcpy(positions + num_vertices, temp_positions, sizeof(vec4) * pole_vertices);
+    memcpy(tex_coords + num_vertices, temp_tex_coords, sizeof(vec2) * pole_vertices);
+
+    num_vertices += pole_vertices;  // update the total vertex count
+
+    free(temp_positions);
+    free(temp_tex_coords);
+}
+
+//blocks for one wall: the north wall of cell (i, j), or its west wall. i == rows / j == cols are the south /
+//east border. writes at most WALL_MAX_VERTICES and returns how many it wrote
+static int emit_wall(const Maze *m, int i, int j, bool west, Rng *rng, vec4 *out_positions, vec2 *out_tex_coords) {
+    // block size and base height
+    float block_size = scale_cube * 0.5f;
+    float base_height = scale_cube;
+
+    //adjust offsets to center the walls
+    float x_offset = -((m->cols * 5 - (m->cols - 1)) / 2.0f) * block_size + 2.5 * block_size;
+    float z_offset = -((m->rows * 5 - (m->rows - 1)) / 2.0f) * block_size + 2.5 * block_size;
+
+    // find base position of current cell
+    float x_cell = j * (5 * block_size - block_size) + x_offset;
+    float z_cell = i * (5 * block_size - block_size) + z_offset;
+
+    int index = 0;
+    for (int segment = 0; segment < 3; ++segment) { //3 segments per wall
+        int wall_height = rng_between(rng, 3, 6); // need random height for each segment
+        for (int h = 0; h < wall_height; ++h) {
+            for (int k = 0; k < num_vertices_per_block; ++k) {
+                out_positions[index] = block_positions[k];
+                if (west) {
+                    out_positions[index].x += x_cell - 2.0f * block_size;  //...for left wall
+                    out_positions[index].z += z_cell + (segment - 1) * block_size;
+                } else {
+                    out_positions[index].x += x_cell + (segment - 1) * block_size;  // offset for segment
+                    out_positions[index].z += z_cell - 2.0f * block_size;  // corrected offset for top wall
+                }
+                out_positions[index].y += base_height + h * block_size;
+                out_tex_coords[index] = block_tex_coords[k];
+                index++;
+            }
+        }
+    }
+    return index;
+}
+
+//make the walls according to the random maze generation
+void generate_maze_walls(const Maze *m, Rng *rng) {
+    int maze_x = m->cols;
+    int maze_z = m->rows;
+
+
+    // brick texture
+    init_texture(1.0f, 0.50f);
+
+    // temp arrays for wall vertices and text coords
+    // each cell owns its north and west wall, the last row/column also add the south/east border
+    int max_wall_blocks = ((maze_x + 1) * (maze_z + 1) * 2) * 15;  // walls are made of 3 segments. segments have max height of 5
+    int max_wall_vertices = max_wall_blocks * num_vertices_per_block;
+
+    vec4 *temp_positions = (vec4 *)malloc(sizeof(vec4) * max_wall_vertices);
+    vec2 *temp_tex_coords = (vec2 *)malloc(sizeof(vec2) * max_wall_vertices);
+
+    if (!temp_positions || !temp_tex_coords) {
+        fprintf(stderr, "Failed to allocate memory for maze walls.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    wall_cols = maze_x;
+    size_t num_edges = (size_t)(maze_x + 1) * (maze_z + 1) * 2;
+    free(wall_first);
+    free(wall_count);
+    wall_first = (int *)malloc(sizeof(int) * num_edges);
+    wall_count = (int *)malloc(sizeof(int) * num_edges);
+    if (!wall_first || !wall_count) {
+        fprintf(stderr, "Failed to allocate memory for wall slots.\n");
+        exit(EXIT_FAILURE);
+    }
+    memset(wall_first, -1, sizeof(int) * num_edges);
+    memset(wall_count, 0, sizeof(int) * num_edges);
+    spare_first = 0;
+    spare_slots = 0;
+    spare_free_count = 0;
+
+    int index = 0;
+
+    // loop through maze grid, one extra row and column for the south and east border
+    for (int i = 0; i <= maze_z; ++i) {
+        for (int j = 0; j <= maze_x; ++j) {
+            // add walls based on maze structure. shared walls are only stored (and drawn) once
+            if (j < maze_x && maze_get_bit(maze_north_row(m, i), j)) {
+                int edge = (i * (maze_x + 1) + j) * 2;
+                wall_first[edge] = num_vertices + index;
+                wall_count[edge] = emit_wall(m, i, j, false, rng, temp_positions + index, temp_tex_coords + index);
+                index += wall_count[edge];
+            }
+
+            if (i < maze_z && maze_get_bit(maze_west_row(m, i), j)) {
+                int edge = (i * (maze_x + 1) + j) * 2 + 1;
+                wall_first[edge] = num_vertices + index;
+                wall_count[edge] = emit_wall(m, i, j, true, rng, temp_positions + index, temp_tex_coords + index);
+                index += wall_count[edge];
+            }
+        }
+    }
+
+    // update global positions and tex_coords as usual
+    int wall_vertices = index; 
+
+    positions = (vec4 *)realloc(positions, sizeof(vec4) * (num_vertices + wall_vertices));
+    tex_coords = (vec2 *)realloc(tex_coords, sizeof(vec2) * (num_vertices + wall_vertices));
+
+    if (!positions || !tex_coords) {
+        fprintf(stderr, "Failed to reallocate memory for maze wall vertices.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    memcpy(positions + num_vertices, temp_positions, sizeof(vec4) * wall_vertices);
+    memcpy(tex_coords + num_vertices, temp_tex_coords, sizeof(vec2) * wall_vertices);
+
+    num_vertices += wall_vertices;  // update total vert count
+
+    free(temp_positions);
+    free(temp_tex_coords);
+}
+
+//empty slots right after the walls for walls put up later (mesh_set_wall)
+void generate_spare_walls(int slots) {
+    int spare_vertices = slots * WALL_MAX_VERTICES;
+    positions = (vec4 *)realloc(positions, sizeof(vec4) * (num_vertices + spare_vertices));
+    tex_coords = (vec2 *)realloc(tex_coords, sizeof(vec2) * (num_vertices + spare_vertices));
+    if (!positions || !tex_coords) {
+        fprintf(stderr, "Failed to reallocate memory for spare wall vertices.\n");
+        exit(EXIT_FAILURE);
+    }
+    memset(positions + num_vertices, 0, sizeof(vec4) * spare_vertices);
+    memset(tex_coords + num_vertices, 0, sizeof(vec2) * spare_vertices);
+    free(spare_free);
+    spare_free = (int *)malloc(sizeof(int) * (slots > 0 ? slots : 1));
+    if (!spare_free) {
+        fprintf(stderr, "Failed to allocate memory for spare wall slots.\n");
+        exit(EXIT_FAILURE);
+    }
+    // slot 0 on top
+    for (int i = 0; i < slots; i++) spare_free[i] = slots - 1 - i;
+    spare_free_count = slots;
+    spare_first = num_vertices;
+    spare_slots = slots;
+    num_vertices += spare_vertices;
+}
+
+//function to bring all maze parts together and display them
+void display_maze(const Maze *m, Rng *rng) {
+    generate_maze_floor(m->cols, m->rows);
+    generate_maze_poles(m->cols, m->rows, rng);
+    generate_maze_walls(m, rng);
+    generate_spare_walls(WALL_SPARE_SLOTS);
+}
+
+bool mesh_set_wall(const Maze *m, int row, int col, int direction, Rng *rng, int *first, int *count) {
+    // the wall belongs to the cell it is the north or west side of
+    if (direction == SOUTH) row++;
+    if (direction == EAST) col++;
+    bool west = direction == EAST || direction == WEST;
+    int edge = (row * (wall_cols + 1) + col) * 2 + west;
+
+    if (!maze_has_wall(m, row, col, west ? WEST : NORTH)) {
+        // taken down: zero its blocks so every triangle collapses to a point
+        if (wall_first[edge] < 0) return false;
+        *first = wall_first[edge];
+        *count = wall_count[edge];
+        memset(positions + *first, 0, sizeof(vec4) * *count);
+        if (*first >= spare_first && *first < spare_first + spare_slots * WALL_MAX_VERTICES) {
+            spare_free[spare_free_count++] = (*first - spare_first) / WALL_MAX_VERTICES;
+        }
+        wall_first[edge] = -1;
+        wall_count[edge] = 0;
+        return true;
+    }
+
+    // put up: a new wall always goes into a spare slot, the blocks it may have had before stay zeroed
+    if (wall_first[edge] >= 0 || spare_free_count == 0) return false;
+    *first = spare_first + spare_free[--spare_free_count] * WALL_MAX_VERTICES;
+    *count = WALL_MAX_VERTICES;
+    init_texture(1.0f, 0.50f);
+    int written = emit_wall(m, row, col, west, rng, positions + *first, tex_coords + *first);
+    memset(positions + *first + written, 0, sizeof(vec4) * (WALL_MAX_VERTICES - written));
+    wall_first[edge] = *first;
+    wall_count[edge] = written;
+    return true;
+}
+
+//drop all the vertices built so far
+void free_mesh() {
+    if (positions) free(positions);
+    if (tex_coords) free(tex_coords);
+    free(wall_first);
+    free(wall_count);
+    free(spare_free);
+    positions = NULL;
+    tex_coords = NULL;
+    wall_first = NULL;
+    wall_count = NULL;
+    spare_free = NULL;
+    num_vertices = 0;
+    spare_first = 0;
+    spare_slots = 0;
+    spare_free_count = 0;
+}
@@ -0,0 +1,40 @@
+#ifndef _MESH_H_
+#define _MESH_H_
+
+#include "tempLib.h"
+#include "maze.h"
+#include "rng.h"
+
+// vertex data for everything in the scene. the builders below append to positions/tex_coords
+// and bump num_vertices, the GL side uploads them once at startup
+extern float scale_cube;
+extern int num_vertices_per_block;
+extern int num_vertices;
+extern vec4 *positions;
+extern vec2 *tex_coords;
+extern vec4 *block_positions;
+extern vec2 *block_tex_coords;
+
+//single block setup
+void init_block();
+void init_texture(float rcornerX, float rcornerY);
+
+// a wall is 3 segments of up to 5 blocks
+#define WALL_MAX_VERTICES (3 * 5 * 36)
+// walls put up at runtime that can be standing at once before the scene has to be built again
+#define WALL_SPARE_SLOTS 64
+
+//maze geometry
+void generate_maze_floor(int maze_x, int maze_z);
+void generate_maze_poles(int maze_x, int maze_z, Rng *rng);
+void generate_maze_walls(const Maze *m, Rng *rng);
+void generate_spare_walls(int slots);
+void display_maze(const Maze *m, Rng *rng);
+void free_mesh();
+
+//after maze_toggle_wall: rewrite just that wall's blocks in positions/tex_coords to match the maze.
+//[*first, *first + *count) are the vertices that changed. false when it cant be done in place (no spare
+//slot left), then the whole scene has to be built again
+bool mesh_set_wall(const Maze *m, int row, int col, int direction, Rng *rng, int *first, int *count);
+
+#endif
@@ -0,0 +1,65 @@
+#include "move_queue.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+static MoveBlock *new_block() {
+    MoveBlock *b = (MoveBlock *)malloc(sizeof(MoveBlock));
+    if (!b) {
+        fprintf(stderr, "Failed to allocate memory for movement queue.\n");
+        exit(EXIT_FAILURE);
+    }
+    b->next = NULL;
+    return b;
+}
+
+void move_queue_init(MoveQueue *q) {
+    q->head = q->tail = new_block();
+    q->popped = 0;
+    q->pushed = 0;
+}
+
+void move_queue_free(MoveQueue *q) {
+    while (q->head) {
+        MoveBlock *next = q->head->next;
+        free(q->head);
+        q->head = next;
+    }
+    q->tail = NULL;
+}
+
+void move_queue_push(MoveQueue *q, uint32_t move) {
+    size_t pushed = __atomic_load_n(&q->pushed, __ATOMIC_RELAXED); // only this side writes it
+    size_t i = pushed % MOVE_BLOCK;
+    if (i == 0 && pushed > 0) {
+        // the block is linked in before the move is published, so the popper always finds it
+        MoveBlock *b = new_block();
+        q->tail->next = b;
+        q->tail = b;
+    }
+    q->tail->moves[i] = move;
+    __atomic_store_n(&q->pushed, pushed + 1, __ATOMIC_RELEASE);
+}
+
+bool move_queue_pop(MoveQueue *q, uint32_t *move) {
+    if (q->popped == __atomic_load_n(&q->pushed, __ATOMIC_ACQUIRE)) return false;
+    size_t i = q->popped % MOVE_BLOCK;
+    if (i == 0 && q->popped > 0) {
+        // finished this block, the pusher moved on to the next one before it pushed this move
+        MoveBlock *done = q->head;
+        q->head = done->next;
+        free(done);
+    }
+    *move = q->head->moves[i];
+    q->popped++;
+    return true;
+}
+
+size_t move_queue_size(MoveQueue *q) {
+    return __atomic_load_n(&q->pushed, __ATOMIC_ACQUIRE) - q->popped;
+}
+
+void move_queue_clear(MoveQueue *q) {
+    uint32_t move;
+    while (move_queue_pop(q, &move)) {
+    }
+}
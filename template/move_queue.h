@@ -0,0 +1,37 @@
+#ifndef _MOVE_QUEUE_H_
+#define _MOVE_QUEUE_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// queue of movement commands with one thread pushing and another popping, no locks. a command is 32 bits
+// and what they mean is up to the caller. it is a list of blocks of MOVE_BLOCK commands: the pushing side
+// links a new block on when the last one is full and the popping side frees a block once it has read all of
+// it, so it never runs out of room and never drops a move. pushed is the only field both sides touch, the
+// pusher stores it after writing the move (release) and the popper loads it before reading (acquire)
+#define MOVE_BLOCK 1024
+
+typedef struct MoveBlock {
+    struct MoveBlock *next;
+    uint32_t moves[MOVE_BLOCK];
+} MoveBlock;
+
+typedef struct {
+    MoveBlock *head;      // popping side
+    size_t popped;
+    MoveBlock *tail;      // pushing side
+    size_t pushed;
+} MoveQueue;
+
+void move_queue_init(MoveQueue *q);
+void move_queue_free(MoveQueue *q);
+//pushing side
+void move_queue_push(MoveQueue *q, uint32_t move);
+//popping side, false when there is nothing queued
+bool move_queue_pop(MoveQueue *q, uint32_t *move);
+size_t move_queue_size(MoveQueue *q);
+//popping side, throws away everything queued. only while nothing is pushing
+void move_queue_clear(MoveQueue *q);
+
+#endif
@@ -0,0 +1,112 @@
+#include "solver.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// paths as runs of steps in one direction. a path is 8 bytes per cell, a run is 4 bytes for a whole
+// straight stretch, and the player turns only where the runs change direction. the cursor hands the runs
+// out one at a time, from a path or straight from a goal field without a path ever being built
+
+void run_path_init(RunPath *r) {
+    memset(r, 0, sizeof(*r));
+}
+
+void run_path_free(RunPath *r) {
+    free(r->runs);
+    run_path_init(r);
+}
+
+size_t run_path_bytes(const RunPath *r) {
+    return (size_t)r->capacity * sizeof(PathRun);
+}
+
+static void push_run(RunPath *r, PathRun run) {
+    if (r->num_runs == r->capacity) {
+        r->capacity = r->capacity ? r->capacity * 2 : 64;
+        r->runs = (PathRun *)realloc(r->runs, sizeof(PathRun) * r->capacity);
+        if (!r->runs) {
+            fprintf(stderr, "Failed to reallocate memory for path runs.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    r->runs[r->num_runs++] = run;
+}
+
+// which way a step goes between two cells next to each other
+static int step_direction(CellPos from, CellPos to) {
+    if (to.row < from.row) return NORTH;
+    if (to.col > from.col) return EAST;
+    if (to.row > from.row) return SOUTH;
+    return WEST;
+}
+
+void route_cursor_path(RouteCursor *c, const Path *p) {
+    c->field = NULL;
+    c->path = p;
+    c->at = 0;
+}
+
+void route_cursor_field(RouteCursor *c, const GoalField *f, CellPos from) {
+    c->field = f;
+    c->path = NULL;
+    c->at = from.row * f->cols + from.col;
+}
+
+bool route_cursor_next(RouteCursor *c, PathRun *run) {
+    if (c->field) {
+        const GoalField *f = c->field;
+        int dir = f->toward[c->at];
+        if (dir == FIELD_GOAL || dir == FIELD_UNREACHED) return false;
+        // cells in a row that step the same way are one run
+        int step = d_row[dir] * f->cols + d_col[dir];
+        *run = (PathRun){(uint32_t)dir, 0};
+        while (f->toward[c->at] == dir) {
+            c->at += step;
+            run->length++;
+        }
+        return true;
+    }
+
+    const Path *p = c->path;
+    if (c->at + 1 >= p->length) return false;
+    int dir = step_direction(p->cells[c->at], p->cells[c->at + 1]);
+    *run = (PathRun){(uint32_t)dir, 0};
+    while (c->at + 1 < p->length && step_direction(p->cells[c->at], p->cells[c->at + 1]) == dir) {
+        c->at++;
+        run->length++;
+    }
+    return true;
+}
+
+void path_to_runs(const Path *p, RunPath *out) {
+    out->num_runs = 0;
+    out->start = p->length > 0 ? p->cells[0] : (CellPos){-1, -1};
+    out->cells = p->length > 0 ? p->length - 1 : 0;
+    RouteCursor c;
+    route_cursor_path(&c, p);
+    PathRun run;
+    while (route_cursor_next(&c, &run)) {
+        push_run(out, run);
+    }
+}
+
+bool run_path_write(const RunPath *r, FILE *out) {
+    static const char letters[] = "NESW";
+    fprintf(out, "start %d %d\n", r->start.row, r->start.col);
+    for (int i = 0; i < r->num_runs; i++) {
+        fprintf(out, "%c%u\n", letters[r->runs[i].direction], (unsigned)r->runs[i].length);
+    }
+    return !ferror(out);
+}
+
+bool run_path_save(const RunPath *r, const char *filename) {
+    FILE *out = fopen(filename, "w");
+    if (!out) {
+        perror(filename);
+        return false;
+    }
+    bool ok = run_path_write(r, out);
+    if (fclose(out) != 0) ok = false;
+    if (!ok) fprintf(stderr, "Failed to write %s.\n", filename);
+    return ok;
+}
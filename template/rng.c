@@ -0,0 +1,18 @@
+#include "rng.h"
+
+// standard pcg32 seeding: pick the stream, then advance past the seed
+void rng_seed(Rng *r, uint64_t seed, uint64_t stream) {
+    r->state = 0;
+    r->inc = (stream << 1) | 1;
+    rng_next(r);
+    r->state += seed;
+    rng_next(r);
+}
+
+// splitmix64 step, good for turning a seed plus some coordinates into a well mixed starting state
+uint64_t rng_mix64(uint64_t *state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
@@ -0,0 +1,48 @@
+#ifndef _RNG_H_
+#define _RNG_H_
+
+#include <stdint.h>
+
+// small seedable random number generator (pcg32). every user keeps its own state
+// so runs can be reproduced from a seed and threads dont fight over rand()
+typedef struct {
+    uint64_t state;
+    uint64_t inc;   // stream selector, always odd
+} Rng;
+
+//seeding
+void rng_seed(Rng *r, uint64_t seed, uint64_t stream);
+uint64_t rng_mix64(uint64_t *state);
+
+// next 32 random bits
+static inline uint32_t rng_next(Rng *r) {
+    uint64_t old = r->state;
+    r->state = old * 6364136223846793005ULL + r->inc;
+    uint32_t xorshifted = (uint32_t)(((old >> 18) ^ old) >> 27);
+    uint32_t rot = (uint32_t)(old >> 59);
+    return (xorshifted >> rot) | (xorshifted << ((-rot) & 31));
+}
+
+// unbiased value in [0, n), multiply + reject instead of % so small ranges arent skewed
+static inline uint32_t rng_bounded(Rng *r, uint32_t n) {
+    uint64_t m = (uint64_t)rng_next(r) * n;
+    uint32_t low = (uint32_t)m;
+    if (low < n) {
+        uint32_t threshold = (0u - n) % n;
+        while (low < threshold) {
+            m = (uint64_t)rng_next(r) * n;
+            low = (uint32_t)m;
+        }
+    }
+    return (uint32_t)(m >> 32);
+}
+
+// helper function for picking rand values in [low, high)
+static inline int rng_between(Rng *r, int low, int high) {
+    if (low >= high) {
+        return low; // avoid invalid range
+    }
+    return low + (int)rng_bounded(r, (uint32_t)(high - low));
+}
+
+#endif
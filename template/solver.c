@@ -0,0 +1,517 @@
+#include "solver.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+const int d_row[4] = {-1, 0, 1, 0};
+const int d_col[4] = {0, 1, 0, -1};
+
+void path_init(Path *p) {
+    p->cells = NULL;
+    p->length = 0;
+    p->capacity = 0;
+    p->expanded = 0;
+}
+
+void path_free(Path *p) {
+    if (p->cells) free(p->cells);
+    path_init(p);
+}
+
+void path_clear(Path *p) {
+    p->length = 0;
+    p->expanded = 0;
+}
+
+void path_push(Path *p, CellPos cell) {
+    if (p->length == p->capacity) {
+        p->capacity = p->capacity ? p->capacity * 2 : 64;
+        p->cells = (CellPos *)realloc(p->cells, sizeof(CellPos) * p->capacity);
+        if (!p->cells) {
+            fprintf(stderr, "Failed to reallocate memory for path.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    p->cells[p->length++] = cell;
+}
+
+// make room for at least capacity cells without changing what is in the path
+void path_reserve(Path *p, int capacity) {
+    if (capacity <= p->capacity) return;
+    p->capacity = capacity;
+    p->cells = (CellPos *)realloc(p->cells, sizeof(CellPos) * p->capacity);
+    if (!p->cells) {
+        fprintf(stderr, "Failed to reallocate memory for path.\n");
+        exit(EXIT_FAILURE);
+    }
+}
+
+void path_reverse(Path *p) {
+    for (int i = 0; i < p->length / 2; i++) {
+        CellPos temp = p->cells[i];
+        p->cells[i] = p->cells[p->length - 1 - i];
+        p->cells[p->length - 1 - i] = temp;
+    }
+}
+
+// entrance is the bottom left cell, exit is the top right one
+CellPos maze_entrance(const Maze *m) {
+    return (CellPos){m->rows - 1, 0};
+}
+
+CellPos maze_exit(const Maze *m) {
+    return (CellPos){0, m->cols - 1};
+}
+
+void workspace_init(SolverWorkspace *ws) {
+    ws->capacity = 0;
+    ws->queue = NULL;
+    ws->parent = NULL;
+    ws->stamp = NULL;
+    ws->generation = 0;
+    ws->compact_capacity = 0;
+    ws->visited_bits = NULL;
+    ws->parent_dirs = NULL;
+    ws->ring = NULL;
+    ws->ring_capacity = 0;
+    ws->astar_capacity = 0;
+    ws->cost = NULL;
+    ws->step_dir = NULL;
+    ws->bucket_head = NULL;
+    ws->bucket_capacity = 0;
+    ws->entries = NULL;
+    ws->entry_capacity = 0;
+    ws->flood_words = 0;
+    ws->flood_bits = NULL;
+    ws->flood_rows = NULL;
+    ws->flood_row_capacity = 0;
+    ws->num_threads = 1;
+    ws->parallel_levels = 0;
+    ws->levels = 0;
+    ws->parallel_cells = 0;
+    ws->claim = NULL;
+    ws->claim_capacity = 0;
+    junction_graph_init(&ws->junctions);
+    goal_field_init(&ws->field);
+    tree_index_init(&ws->tree);
+    hpa_index_init(&ws->hpa);
+    dstar_init(&ws->dstar);
+    wall_walk_init(&ws->walk);
+}
+
+void workspace_free(SolverWorkspace *ws) {
+    if (ws->queue) free(ws->queue);
+    if (ws->parent) free(ws->parent);
+    if (ws->stamp) free(ws->stamp);
+    if (ws->visited_bits) free(ws->visited_bits);
+    if (ws->parent_dirs) free(ws->parent_dirs);
+    if (ws->ring) free(ws->ring);
+    if (ws->cost) free(ws->cost);
+    if (ws->step_dir) free(ws->step_dir);
+    if (ws->bucket_head) free(ws->bucket_head);
+    if (ws->entries) free(ws->entries);
+    if (ws->flood_bits) free(ws->flood_bits);
+    if (ws->flood_rows) free(ws->flood_rows);
+    if (ws->claim) free(ws->claim);
+    junction_graph_free(&ws->junctions);
+    goal_field_free(&ws->field);
+    tree_index_free(&ws->tree);
+    hpa_index_free(&ws->hpa);
+    dstar_free(&ws->dstar);
+    wall_walk_free(&ws->walk);
+    workspace_init(ws);
+}
+
+// get the buffers ready for a maze with num_cells cells. they are only reallocated when the maze is
+// bigger than any before it, otherwise this is just a generation bump
+void workspace_begin(SolverWorkspace *ws, size_t num_cells) {
+    if (num_cells > ws->capacity) {
+        free(ws->queue);
+        free(ws->parent);
+        free(ws->stamp);
+        ws->capacity = num_cells;
+        ws->queue = (int *)malloc(sizeof(int) * num_cells);
+        ws->parent = (int *)malloc(sizeof(int) * num_cells);
+        ws->stamp = (uint32_t *)calloc(num_cells, sizeof(uint32_t));
+        if (!ws->queue || !ws->parent || !ws->stamp) {
+            fprintf(stderr, "Failed to allocate memory for solver workspace.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    ws->generation++;
+    if (ws->generation == 0) {
+        // wrapped around after 4 billion solves, old stamps could look current again
+        memset(ws->stamp, 0, sizeof(uint32_t) * ws->capacity);
+        ws->generation = 1;
+    }
+}
+
+// compact buffers for a maze with num_cells cells. the visited bits are cleared every time,
+// that is only 1 bit per cell so its cheaper than keeping stamps around
+void workspace_begin_compact(SolverWorkspace *ws, size_t num_cells) {
+    size_t words = (num_cells + 63) / 64;
+    if (num_cells > ws->compact_capacity) {
+        free(ws->visited_bits);
+        free(ws->parent_dirs);
+        ws->compact_capacity = num_cells;
+        ws->visited_bits = (uint64_t *)malloc(sizeof(uint64_t) * words);
+        ws->parent_dirs = (uint8_t *)malloc((num_cells + 3) / 4);
+        if (!ws->visited_bits || !ws->parent_dirs) {
+            fprintf(stderr, "Failed to allocate memory for solver workspace.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    if (!ws->ring) {
+        ws->ring_capacity = 1024;
+        ws->ring = (int *)malloc(sizeof(int) * ws->ring_capacity);
+        if (!ws->ring) {
+            fprintf(stderr, "Failed to allocate memory for solver workspace.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    memset(ws->visited_bits, 0, sizeof(uint64_t) * words);
+}
+
+// heap the workspace is holding on to right now
+size_t workspace_bytes(const SolverWorkspace *ws) {
+    size_t bytes = ws->capacity * (sizeof(int) * 2 + sizeof(uint32_t));
+    bytes += (ws->compact_capacity + 63) / 64 * sizeof(uint64_t) + (ws->compact_capacity + 3) / 4;
+    bytes += ws->ring_capacity * sizeof(int);
+    bytes += ws->astar_capacity * (sizeof(int) + sizeof(uint8_t));
+    bytes += ws->bucket_capacity * sizeof(int) + ws->entry_capacity * sizeof(OpenEntry);
+    bytes += ws->flood_words * sizeof(uint64_t) + ws->flood_row_capacity * 3 * sizeof(int);
+    bytes += ws->claim_capacity * sizeof(uint64_t);
+    bytes += junction_graph_bytes(&ws->junctions);
+    bytes += goal_field_bytes(&ws->field);
+    bytes += tree_index_bytes(&ws->tree);
+    bytes += hpa_index_bytes(&ws->hpa);
+    bytes += dstar_bytes(&ws->dstar);
+    bytes += wall_walk_bytes(&ws->walk);
+    return bytes;
+}
+
+// the indexes are built for one exact set of walls, any change means building them again
+static void drop_indexes(SolverWorkspace *ws) {
+    ws->junctions.bits = NULL;
+    ws->field.bits = NULL;
+    ws->tree.bits = NULL;
+    ws->hpa.bits = NULL;
+}
+
+void workspace_maze_changed(SolverWorkspace *ws) {
+    drop_indexes(ws);
+    ws->dstar.bits = NULL;
+}
+
+void workspace_wall_changed(SolverWorkspace *ws, const Maze *m, int row, int col, int direction) {
+    drop_indexes(ws);
+    dstar_wall_changed(&ws->dstar, m, row, col, direction);
+}
+
+//shortest path alg using breadth-first search algorithm
+bool solve_bfs(const Maze *m, CellPos start, CellPos goal, SolverWorkspace *ws, Path *out) {
+    int rows = m->rows;
+    int cols = m->cols;
+
+    // cells are stored as row * cols + col
+    workspace_begin(ws, (size_t)rows * cols);
+    int *queue = ws->queue;
+    int *parent = ws->parent;
+
+    path_clear(out);
+    int start_index = start.row * cols + start.col;
+    int goal_index = goal.row * cols + goal.col;
+    size_t front = 0, back = 0;
+    queue[back++] = start_index;
+    workspace_visit(ws, start_index, start_index);
+
+    bool found_goal = false;
+    while (front < back) {
+        int current = queue[front++];
+        out->expanded++;
+
+        if (current == goal_index) {
+            found_goal = true;
+            break;
+        }
+
+        int row = current / cols;
+        int col = current % cols;
+
+        // explore the 4 neighboring units that arent blocked by a wall
+        for (int dir = 0; dir < 4; dir++) {
+            int new_row = row + d_row[dir];
+            int new_col = col + d_col[dir];
+            if (new_row < 0 || new_row >= rows || new_col < 0 || new_col >= cols) continue;
+            if (maze_has_wall(m, row, col, dir)) continue;
+
+            int next = new_row * cols + new_col;
+            if (workspace_visited(ws, next)) continue;
+            workspace_visit(ws, next, current);
+            queue[back++] = next;
+        }
+    }
+
+    if (found_goal) {
+        // walk the parents back from the goal then flip it around
+        for (int cell = goal_index; ; cell = parent[cell]) {
+            path_push(out, (CellPos){cell / cols, cell % cols});
+            if (cell == start_index) break;
+        }
+        path_reverse(out);
+    }
+    return found_goal;
+}
+
+// one level of a bidirectional search: every cell in queue[*front, *back) (this side's frontier) is expanded
+// and the new cells are appended after it. step is +1 for the forward queue that grows up from the
+// start of ws->queue and -1 for the backward one that grows down from the end. returns true and fills in
+// the meeting pair (this side's cell, other side's cell) on the first contact with the other side
+static bool expand_level(const Maze *m, SolverWorkspace *ws, long *front, long *back, int step,
+                         uint32_t own, uint32_t other, long *expanded, int *meet_own, int *meet_other) {
+    int rows = m->rows;
+    int cols = m->cols;
+    long level_end = *back;
+    while (*front != level_end) {
+        int current = ws->queue[*front];
+        *front += step;
+        (*expanded)++;
+
+        int row = current / cols;
+        int col = current % cols;
+        for (int dir = 0; dir < 4; dir++) {
+            int new_row = row + d_row[dir];
+            int new_col = col + d_col[dir];
+            if (new_row < 0 || new_row >= rows || new_col < 0 || new_col >= cols) continue;
+            if (maze_has_wall(m, row, col, dir)) continue;
+
+            int next = new_row * cols + new_col;
+            if (ws->stamp[next] == other) {
+                *meet_own = current;
+                *meet_other = next;
+                return true;
+            }
+            if (ws->stamp[next] == own) continue;
+            ws->stamp[next] = own;
+            ws->parent[next] = current;
+            ws->queue[*back] = next;
+            *back += step;
+        }
+    }
+    return false;
+}
+
+// bfs from both ends at once, a whole level of whichever frontier is smaller at a time. the first contact
+// is always on the other side's newest level, so it already gives a shortest path and the two halves are
+// joined there. in a perfect maze that is the same path solve_bfs finds, with far fewer cells expanded
+bool solve_bfs_bidirectional(const Maze *m, CellPos start, CellPos goal, SolverWorkspace *ws, Path *out) {
+    int cols = m->cols;
+    long num_cells = (long)m->rows * cols;
+
+    // two generations, one per side
+    workspace_begin(ws, (size_t)num_cells);
+    uint32_t forward = ws->generation;
+    workspace_begin(ws, (size_t)num_cells);
+    uint32_t backward = ws->generation;
+
+    path_clear(out);
+    int start_index = start.row * cols + start.col;
+    int goal_index = goal.row * cols + goal.col;
+    if (start_index == goal_index) {
+        out->expanded = 1;
+        path_push(out, start);
+        return true;
+    }
+
+    // each cell is only ever queued by one side so both queues fit in one array
+    long forward_front = 0, forward_back = 0;
+    long backward_front = num_cells - 1, backward_back = num_cells - 1;
+    ws->queue[forward_back++] = start_index;
+    ws->queue[backward_back--] = goal_index;
+    ws->stamp[start_index] = forward;
+    ws->parent[start_index] = start_index;
+    ws->stamp[goal_index] = backward;
+    ws->parent[goal_index] = goal_index;
+
+    int meet_forward = -1, meet_backward = -1;
+    bool found_goal = false;
+    while (!found_goal && forward_front < forward_back && backward_front > backward_back) {
+        long forward_size = forward_back - forward_front;
+        long backward_size = backward_front - backward_back;
+        if (forward_size <= backward_size) {
+            found_goal = expand_level(m, ws, &forward_front, &forward_back, 1, forward, backward,
+                                      &out->expanded, &meet_forward, &meet_backward);
+        } else {
+            found_goal = expand_level(m, ws, &backward_front, &backward_back, -1, backward, forward,
+                                      &out->expanded, &meet_backward, &meet_forward);
+        }
+    }
+
+    if (found_goal) {
+        // start ... meet_forward, reversed, then meet_backward ... goal
+        for (int cell = meet_forward; ; cell = ws->parent[cell]) {
+            path_push(out, (CellPos){cell / cols, cell % cols});
+            if (cell == start_index) break;
+        }
+        path_reverse(out);
+        for (int cell = meet_backward; ; cell = ws->parent[cell]) {
+            path_push(out, (CellPos){cell / cols, cell % cols});
+            if (cell == goal_index) break;
+        }
+    }
+    return found_goal;
+}
+
+// double the ring, unwrapping it so the queued cells start at 0 again
+static void grow_ring(SolverWorkspace *ws, size_t *front, size_t *back) {
+    size_t count = *back - *front;
+    size_t mask = ws->ring_capacity - 1;
+    int *ring = (int *)malloc(sizeof(int) * ws->ring_capacity * 2);
+    if (!ring) {
+        fprintf(stderr, "Failed to reallocate memory for solver queue.\n");
+        exit(EXIT_FAILURE);
+    }
+    for (size_t i = 0; i < count; i++) ring[i] = ws->ring[(*front + i) & mask];
+    free(ws->ring);
+    ws->ring = ring;
+    ws->ring_capacity *= 2;
+    *front = 0;
+    *back = count;
+}
+
+static inline int get_parent_dir(const uint8_t *dirs, size_t cell) {
+    return (dirs[cell >> 2] >> ((cell & 3) * 2)) & 3;
+}
+
+static inline void put_parent_dir(uint8_t *dirs, size_t cell, int dir) {
+    int shift = (int)(cell & 3) * 2;
+    dirs[cell >> 2] = (uint8_t)((dirs[cell >> 2] & ~(3 << shift)) | (dir << shift));
+}
+
+// same search as solve_bfs but each cell only costs 3 bits: a visited bit and the direction it was
+// entered from (an index into d_row/d_col). the path is rebuilt by stepping back against those
+// directions from the goal. the queue is a ring that only ever holds the current frontier
+bool solve_bfs_compact(const Maze *m, CellPos start, CellPos goal, SolverWorkspace *ws, Path *out) {
+    int rows = m->rows;
+    int cols = m->cols;
+    workspace_begin_compact(ws, (size_t)rows * cols);
+    uint64_t *visited = ws->visited_bits;
+    uint8_t *dirs = ws->parent_dirs;
+
+    path_clear(out);
+    int start_index = start.row * cols + start.col;
+    int goal_index = goal.row * cols + goal.col;
+    size_t front = 0, back = 0;
+    ws->ring[back++] = start_index;
+    maze_put_bit(visited, start_index, true);
+
+    bool found_goal = false;
+    while (front < back) {
+        int current = ws->ring[front++ & (ws->ring_capacity - 1)];
+        out->expanded++;
+
+        if (current == goal_index) {
+            found_goal = true;
+            break;
+        }
+
+        int row = current / cols;
+        int col = current % cols;
+        for (int dir = 0; dir < 4; dir++) {
+            int new_row = row + d_row[dir];
+            int new_col = col + d_col[dir];
+            if (new_row < 0 || new_row >= rows || new_col < 0 || new_col >= cols) continue;
+            if (maze_has_wall(m, row, col, dir)) continue;
+
+            int next = new_row * cols + new_col;
+            if (maze_get_bit(visited, next)) continue;
+            maze_put_bit(visited, next, true);
+            put_parent_dir(dirs, (size_t)next, dir);
+
+            if (back - front == ws->ring_capacity) grow_ring(ws, &front, &back);
+            ws->ring[back++ & (ws->ring_capacity - 1)] = next;
+        }
+    }
+
+    if (found_goal) {
+        int row = goal.row, col = goal.col;
+        path_push(out, goal);
+        while (row != start.row || col != start.col) {
+            int dir = get_parent_dir(dirs, (size_t)row * cols + col);
+            row -= d_row[dir];
+            col -= d_col[dir];
+            path_push(out, (CellPos){row, col});
+        }
+        path_reverse(out);
+    }
+    return found_goal;
+}
+
+// left-hand rule walk, starting from the start cell facing north like the player does after entering.
+// the path has every cell the walker steps on (so it can revisit cells), walk_left_hand works out the moves
+// and stops at the first repeated state if it goes in circles
+bool solve_left_hand(const Maze *m, CellPos start, CellPos goal, SolverWorkspace *ws, Path *out) {
+    WallWalk *walk = &ws->walk;
+    WalkResult result = walk_left_hand(m, start, NORTH, goal, walk);
+
+    path_clear(out);
+    out->expanded = walk->steps + walk->turns;
+    path_reserve(out, (int)(walk->steps + 1));
+    path_push(out, start);
+    int row = start.row, col = start.col, direction = NORTH;
+    for (long i = 0; i < walk->num_moves; i++) {
+        switch (walk->moves[i]) {
+            case WALK_TURN_LEFT: direction = (direction + 3) % 4; break;
+            case WALK_TURN_RIGHT: direction = (direction + 1) % 4; break;
+            case WALK_FORWARD:
+                row += d_row[direction];
+                col += d_col[direction];
+                out->cells[out->length++] = (CellPos){row, col};
+                break;
+        }
+    }
+    return result == WALK_REACHED_GOAL;
+}
+
+static const SolverInfo solvers[] = {
+    {"bfs", solve_bfs},
+    {"bfs-compact", solve_bfs_compact},
+    {"bfs-parallel", solve_bfs_parallel},
+    {"bibfs", solve_bfs_bidirectional},
+    {"astar", solve_astar},
+    {"flood", solve_flood},
+    {"junction", solve_junction},
+    {"field", solve_field},
+    {"tree", solve_tree},
+    {"hpa", solve_hpa},
+    {"dstar", solve_dstar},
+    {"lh", solve_left_hand},
+};
+
+// all registered solvers, for tools that want to run every one of them
+const SolverInfo *get_solvers(int *count) {
+    *count = (int)(sizeof(solvers) / sizeof(solvers[0]));
+    return solvers;
+}
+
+bool maze_fits_solvers(int rows, int cols) {
+    if ((size_t)rows * cols <= MAX_SOLVE_CELLS) return true;
+    fprintf(stderr, "A %dx%d maze has %zu cells, the solvers handle at most %zu. Use --generator eller --stream "
+            "to write it out without solving.\n", cols, rows, (size_t)rows * cols, MAX_SOLVE_CELLS);
+    return false;
+}
+
+const SolverInfo *find_solver(const char *name) {
+    for (size_t i = 0; i < sizeof(solvers) / sizeof(solvers[0]); i++) {
+        if (strcmp(solvers[i].name, name) == 0) return &solvers[i];
+    }
+    return NULL;
+}
+
+void list_solvers(FILE *out) {
+    for (size_t i = 0; i < sizeof(solvers) / sizeof(solvers[0]); i++) {
+        fprintf(out, "%s%s", i ? ", " : "", solvers[i].name);
+    }
+    fprintf(out, "\n");
+}
@@ -0,0 +1,446 @@
+#ifndef _SOLVER_H_
+#define _SOLVER_H_
+
+#include <limits.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "maze.h"
+
+// every solver numbers cells row * cols + col in an int, so no maze with more cells than this can be solved.
+// streaming one out without solving it has no such limit
+#define MAX_SOLVE_CELLS ((size_t)INT_MAX)
+
+// a cell in the maze grid
+typedef struct {
+    int row, col;
+} CellPos;
+
+// route found by a solver, cells[0] is the start and cells[length - 1] the goal
+typedef struct {
+    CellPos *cells;
+    int length;
+    int capacity;
+    long expanded;   // cells the solver took off its open list, for comparing solvers
+} Path;
+
+// the same route as straight runs (path_runs.c): from start, length cells in direction, then the next run.
+// corridors make most routes a few long runs, so this is a fraction of the size of the cells and each
+// run plays back as one move
+typedef struct {
+    uint32_t direction : 2;
+    uint32_t length : 30;
+} PathRun;
+
+typedef struct {
+    CellPos start;
+    PathRun *runs;
+    int num_runs;
+    int capacity;
+    long cells;      // cells stepped through, the path length minus the start
+} RunPath;
+
+// one entry in the a* bucket queue, entries for the same f are chained through next
+typedef struct {
+    int cell;
+    int cost;    // g when it was pushed, older entries for the same cell are skipped
+    int next;
+} OpenEntry;
+
+// a corridor in the junction graph. cells[first .. first + count) are the cells between its two
+// nodes walking from -> to, the nodes themselves arent included
+typedef struct {
+    int from, to;
+    int first, count;
+} Corridor;
+
+typedef struct {
+    int dist;
+    int node;
+} HeapEntry;
+
+// the maze boiled down to its junctions and dead ends (solver_junction.c). cells with exactly two
+// open sides are only stored in the corridor between two nodes. it is built the first time the
+// junction solver sees a maze and reused until the maze changes
+typedef struct {
+    const uint64_t *bits;     // walls of the maze it was built from, NULL when there is none
+    int rows, cols;
+    size_t cell_capacity;
+    int *owner;               // per cell, its node id or -(corridor + 1)
+    int *position;            // per corridor cell, where it is in its corridor
+    int *corridor_cells;
+
+    int num_nodes, node_capacity;
+    int *node_cell;
+    int num_corridors, corridor_capacity;
+    Corridor *corridors;
+    int *edge_start;          // corridors at node n are edges[edge_start[n] .. edge_start[n + 1])
+    int *edges;
+
+    // dijkstra, per node
+    int *dist;
+    int *prev;                // corridor it was reached through, -1 / -2 when it was a start side
+    uint32_t *stamp;
+    uint32_t generation;
+    HeapEntry *heap;
+    size_t heap_capacity;
+    int *chain;               // corridors on the way back while building the path
+} JunctionGraph;
+
+// distance field toward one goal (solver_field.c): a bfs outward from the goal that remembers how far
+// every cell it reached is and which way it steps toward the goal. the bfs stops as soon as it reaches
+// the cell being solved from and carries on from there next time, so once it covers the maze a solve
+// to that goal is just following the steps
+typedef struct {
+    const uint64_t *bits;     // walls of the maze it was built from, NULL when there is none
+    int rows, cols;
+    int goal;
+    size_t cell_capacity;
+    uint8_t *toward;          // per cell, FIELD_UNREACHED until the bfs gets there
+    int *dist;                // only valid for reached cells
+    int *queue;
+    size_t front, back;       // where the bfs stopped, front == back once it has covered the maze
+} GoalField;
+
+// hands out a route one straight run at a time (path_runs.c), from a solved path or straight from a goal
+// field. following the field never builds anything the size of the route, so a caller that only asks for
+// the next run when it needs it can start walking at once and stays small however long the route is
+typedef struct {
+    const GoalField *field;   // following the field toward its goal, or
+    const Path *path;         // walking a solved path
+    int at;                   // cell (field) or index into path->cells (path) the next run starts from
+} RouteCursor;
+
+#define FIELD_UNREACHED 0xFF
+#define FIELD_GOAL 4          // toward of the goal cell itself, the rest hold a direction 0-3
+
+// lca index for mazes without loops (solver_tree.c). the passages of a perfect maze form a spanning tree,
+// so the distance between two cells is depth(a) + depth(b) - 2 * depth(lca). the cells are laid out in
+// dfs preorder and the lca comes from the shallowest cell between the two in that order, found in O(1)
+// with a sparse table over blocks of 32 cells plus a bit mask per cell for the part inside a block
+typedef struct {
+    const uint64_t *bits;     // walls of the maze it was built from, NULL when there is none
+    int rows, cols;
+    bool is_tree;             // false when the maze has a loop, then queries fall back to bfs
+    size_t cell_capacity;
+    int *depth;               // per cell
+    int *tin;                 // per cell, where it is in the preorder
+    int *order;               // per preorder position, the cell
+    uint8_t *up;              // per cell, direction of its parent or TREE_ROOT
+    uint32_t *block_mask;     // per preorder position, doubles as the dfs stack while building
+    int *table;               // per level, the shallowest position in 2^level blocks from each block
+    size_t table_capacity;
+    int num_blocks;
+} TreeIndex;
+
+#define TREE_UNSEEN 0xFF
+#define TREE_ROOT 4           // up of the first cell of every connected part
+
+// hierarchical index (solver_hpa.c). the maze is cut into HPA_TILE x HPA_TILE tiles, every cell on the edge
+// of a tile with an open passage into the next tile is a node, and the nodes of a tile are joined by their
+// shortest distance inside it. a solve searches that graph and only runs a bfs in the tiles it passes through
+#define HPA_TILE 32
+#define HPA_TILE_CELLS (HPA_TILE * HPA_TILE)
+#define HPA_TILE_NODES (4 * HPA_TILE)
+
+typedef struct {
+    int to;
+    int cost;
+} HpaEdge;
+
+typedef struct {
+    const uint64_t *bits;     // walls of the maze it was built from, NULL when there is none
+    int rows, cols;
+    int tiles_x, tiles_y;
+    int *tile_first;          // nodes of tile t are tile_first[t] .. tile_first[t + 1] - 1
+    size_t tile_capacity;
+    int num_nodes, node_capacity;
+    int *node_cell;
+    int *edge_start;          // edges of node n are edges[edge_start[n] .. edge_start[n + 1])
+    HpaEdge *edges;
+    size_t num_edges, edge_capacity;
+
+    // a* over the nodes
+    int *cost;
+    int *prev;                // node it was reached from, -1 when it was reached from the start cell
+    uint32_t *stamp;
+    uint32_t generation;
+    HeapEntry *heap;
+    size_t heap_capacity;
+    int *chain;
+
+    // bfs inside one tile, indexed by the cell's row and column in the tile
+    int local_dist[HPA_TILE_CELLS];
+    uint8_t local_up[HPA_TILE_CELLS];   // direction toward the cell the bfs started from
+    int local_queue[HPA_TILE_CELLS];
+    int goal_dist[HPA_TILE_NODES];      // goal cell to every node of its tile, -1 if cut off
+} HpaIndex;
+
+// d* lite (solver_dstar.c). it searches from the goal back toward the start and keeps its g and rhs values
+// between solves, so when a wall changes only the cells whose distance it changed are searched again,
+// and when the start moves the old values stay good (km keeps the old queue keys comparable)
+typedef struct {
+    uint64_t key;             // the two part key packed so one compare orders it
+    int cell;
+} DStarEntry;
+
+typedef struct {
+    const uint64_t *bits;     // walls of the maze it was built from, NULL when there is none
+    int rows, cols;
+    int goal;
+    int last_start;
+    int km;
+    size_t cell_capacity;
+    int *g;
+    int *rhs;                 // one step ahead of g, the cell is settled when they agree
+    DStarEntry *heap;         // can hold old entries, they are dropped when they come out
+    size_t heap_size, heap_capacity;
+} DStarLite;
+
+// a whole left hand rule walk worked out in one go (solver_walk.c). the walker only ever has rows * cols * 4
+// (cell, direction) states and the next one only depends on the current one, so the first state it sees twice
+// means it is going round in circles. seen has one bit per state
+typedef enum {
+    WALK_FORWARD,
+    WALK_TURN_LEFT,
+    WALK_TURN_RIGHT
+} WalkMove;
+
+typedef enum {
+    WALK_REACHED_GOAL,
+    WALK_LOOPED,              // came back to a state it was already in
+    WALK_LEFT_MAZE            // stepped out of an opening that isnt the goal (the entrance)
+} WalkResult;
+
+typedef struct {
+    uint8_t *moves;           // WalkMove values, one per turn or step
+    long num_moves;
+    size_t move_capacity;
+    uint64_t *seen;
+    size_t seen_words;
+    WalkResult result;
+    long steps;               // forward moves
+    long turns;
+    long loop_steps;          // forward moves around the loop, 0 unless it looped
+    CellPos end;              // where the walk stopped and which way it faces there
+    int end_direction;
+} WallWalk;
+
+// a batch of routes on one maze (solver_batch.c). queries that share a goal are answered by one bfs outward
+// from that goal, which stops once it has reached all of their starts, and the goals are shared out between
+// threads. nothing is animated or queued, it only fills in the answers
+typedef struct {
+    CellPos start, goal;
+} RouteQuery;
+
+typedef struct {
+    int distance;             // steps from start to goal, -1 if it cant be reached
+    int first_run;            // its route is runs[first_run .. first_run + num_runs) of the batch
+    int num_runs;             // 0 unless paths were asked for
+} RouteAnswer;
+
+typedef struct {
+    RouteAnswer *answers;     // one per query, in the same order
+    int answer_capacity;
+    PathRun *runs;            // grouped by the thread that found them, not in query order
+    size_t num_runs, run_capacity;
+    int num_goals;            // searches it ran
+    long expanded;            // cells all of them took off their queues
+    GoalField *fields;        // one per thread, kept for the next batch
+    int num_fields;
+} RouteBatch;
+
+// scratch buffers shared by the solvers. they grow to the biggest maze seen and are kept between solves,
+// and instead of clearing them every solve bumps generation: a cell is visited when stamp == generation
+typedef struct {
+    size_t capacity;      // cells the buffers can hold
+    int *queue;
+    int *parent;          // only valid for visited cells
+    uint32_t *stamp;
+    uint32_t generation;
+
+    // compact mode (solve_bfs_compact), 1 visited bit + a 2 bit parent direction per cell and a ring
+    // buffer that only has to hold the frontier
+    size_t compact_capacity;
+    uint64_t *visited_bits;
+    uint8_t *parent_dirs;     // 4 cells per byte
+    int *ring;
+    size_t ring_capacity;     // power of two
+
+    // a* (solver_astar.c), g of every visited cell and the direction of the first corridor step
+    // it was reached through, plus the bucket queue keyed on f = g + h
+    size_t astar_capacity;
+    int *cost;
+    uint8_t *step_dir;
+    int *bucket_head;         // first entry for each f, -1 when empty
+    size_t bucket_capacity;
+    OpenEntry *entries;
+    size_t entry_capacity;
+
+    // flood fill (solver_flood.c), bitplanes laid out like the maze rows: visited, frontier, next and
+    // three planes saying which cells have distance % 3 == 0, 1 or 2, then one row that stays zero
+    size_t flood_words;       // size of flood_bits in words
+    uint64_t *flood_bits;
+    int *flood_rows;          // active row lists, 3 ints per row
+    size_t flood_row_capacity;
+
+    // parallel bfs (solver_parallel.c), uses the queue, parents and visited bits above plus a claim per
+    // cell: the generation in the high half, which frontier cell got there first in the low half
+    int num_threads;          // threads solve_bfs_parallel may use, 1 unless the caller sets it
+    int parallel_levels;      // levels the last solve_bfs_parallel split over the threads
+    int levels;               // and all the levels it ran
+    long parallel_cells;      // frontier cells in the split levels
+    uint64_t *claim;
+    size_t claim_capacity;
+
+    JunctionGraph junctions;
+    GoalField field;
+    TreeIndex tree;
+    HpaIndex hpa;
+    DStarLite dstar;
+    WallWalk walk;            // solve_left_hand
+} SolverWorkspace;
+
+// every solver has this shape so the keyboard handler and headless mode can pick one by name
+typedef bool (*SolveFn)(const Maze *m, CellPos start, CellPos goal, SolverWorkspace *ws, Path *out);
+
+typedef struct {
+    const char *name;
+    SolveFn solve;
+} SolverInfo;
+
+// direction offsets: (North, East, South, West) used to calculate position in next cell
+extern const int d_row[4];
+extern const int d_col[4];
+
+//path helpers
+void path_init(Path *p);
+void path_free(Path *p);
+void path_clear(Path *p);
+void path_push(Path *p, CellPos cell);
+void path_reserve(Path *p, int capacity);
+void path_reverse(Path *p);
+
+//run length paths
+void run_path_init(RunPath *r);
+void run_path_free(RunPath *r);
+void path_to_runs(const Path *p, RunPath *out);
+size_t run_path_bytes(const RunPath *r);
+void route_cursor_path(RouteCursor *c, const Path *p);
+void route_cursor_field(RouteCursor *c, const GoalField *f, CellPos from);
+//false once the route has reached its end
+bool route_cursor_next(RouteCursor *c, PathRun *run);
+//text file: a "start row col" line, then one run per line as a direction letter (NESW) and a length
+bool run_path_write(const RunPath *r, FILE *out);
+bool run_path_save(const RunPath *r, const char *filename);
+
+// quarter turns from facing one direction to another the short way round: -1 is one turn left,
+// 1 one turn right, 2 turning around
+static inline int shortest_turn(int from, int to) {
+    int turns = (to - from + 4) % 4;
+    return turns == 3 ? -1 : turns;
+}
+
+//workspace, call workspace_begin at the start of every solve
+void workspace_init(SolverWorkspace *ws);
+void workspace_free(SolverWorkspace *ws);
+void workspace_begin(SolverWorkspace *ws, size_t num_cells);
+void workspace_begin_compact(SolverWorkspace *ws, size_t num_cells);
+size_t workspace_bytes(const SolverWorkspace *ws);
+//anything cached about the maze (junction graph, goal field, tree and hpa index) gets rebuilt on the next solve
+void workspace_maze_changed(SolverWorkspace *ws);
+//one wall of (row, col) was added or removed: the indexes are dropped, d* lite repairs what it has
+void workspace_wall_changed(SolverWorkspace *ws, const Maze *m, int row, int col, int direction);
+
+static inline bool workspace_visited(const SolverWorkspace *ws, int cell) {
+    return ws->stamp[cell] == ws->generation;
+}
+
+static inline void workspace_visit(SolverWorkspace *ws, int cell, int parent) {
+    ws->stamp[cell] = ws->generation;
+    ws->parent[cell] = parent;
+}
+
+//where you enter and leave the maze
+CellPos maze_entrance(const Maze *m);
+CellPos maze_exit(const Maze *m);
+
+//solvers
+bool solve_bfs(const Maze *m, CellPos start, CellPos goal, SolverWorkspace *ws, Path *out);
+bool solve_bfs_bidirectional(const Maze *m, CellPos start, CellPos goal, SolverWorkspace *ws, Path *out);
+bool solve_bfs_compact(const Maze *m, CellPos start, CellPos goal, SolverWorkspace *ws, Path *out);
+bool solve_bfs_parallel(const Maze *m, CellPos start, CellPos goal, SolverWorkspace *ws, Path *out);
+bool solve_astar(const Maze *m, CellPos start, CellPos goal, SolverWorkspace *ws, Path *out);
+bool solve_flood(const Maze *m, CellPos start, CellPos goal, SolverWorkspace *ws, Path *out);
+bool solve_junction(const Maze *m, CellPos start, CellPos goal, SolverWorkspace *ws, Path *out);
+bool solve_field(const Maze *m, CellPos start, CellPos goal, SolverWorkspace *ws, Path *out);
+bool solve_tree(const Maze *m, CellPos start, CellPos goal, SolverWorkspace *ws, Path *out);
+bool solve_hpa(const Maze *m, CellPos start, CellPos goal, SolverWorkspace *ws, Path *out);
+bool solve_dstar(const Maze *m, CellPos start, CellPos goal, SolverWorkspace *ws, Path *out);
+bool solve_left_hand(const Maze *m, CellPos start, CellPos goal, SolverWorkspace *ws, Path *out);
+
+//flood fill distance without building the path, -1 if goal cant be reached
+int flood_distance(const Maze *m, CellPos start, CellPos goal, SolverWorkspace *ws);
+//switch the flood fill between its avx2 and plain 64 bit code, returns whether avx2 is now in use
+bool flood_use_avx2(bool enable);
+
+//junction graph, solve_junction builds it on demand
+void junction_graph_init(JunctionGraph *g);
+void junction_graph_free(JunctionGraph *g);
+void junction_graph_build(JunctionGraph *g, const Maze *m);
+size_t junction_graph_bytes(const JunctionGraph *g);
+
+//goal field, solve_field fills it in as far as each solve needs. goal_field_build does the whole
+//maze up front so every solve after it only follows the steps
+void goal_field_init(GoalField *f);
+void goal_field_free(GoalField *f);
+void goal_field_build(GoalField *f, const Maze *m, CellPos goal);
+size_t goal_field_bytes(const GoalField *f);
+//carry the field on until it reaches from (what solve_field does before following it), false if it cant
+bool goal_field_reach(GoalField *f, const Maze *m, CellPos from, CellPos goal, long *expanded);
+//steps from cell to the goal the field was built for, -1 if the bfs hasnt reached it (yet)
+int goal_field_distance(const GoalField *f, CellPos cell);
+
+//tree index, solve_tree and tree_distance build it on demand. build returns whether the maze has no loops
+void tree_index_init(TreeIndex *t);
+void tree_index_free(TreeIndex *t);
+bool tree_index_build(TreeIndex *t, const Maze *m);
+size_t tree_index_bytes(const TreeIndex *t);
+//steps between a and b without searching (bfs if the maze has loops), -1 if b cant be reached
+int tree_distance(const Maze *m, CellPos a, CellPos b, SolverWorkspace *ws);
+
+//hpa index, solve_hpa builds it on demand. callers that want to report the build time can build it first
+void hpa_index_init(HpaIndex *h);
+void hpa_index_free(HpaIndex *h);
+void hpa_index_build(HpaIndex *h, const Maze *m);
+size_t hpa_index_bytes(const HpaIndex *h);
+
+//d* lite state, solve_dstar starts it the first time it sees a maze or goal
+void dstar_init(DStarLite *d);
+void dstar_free(DStarLite *d);
+void dstar_wall_changed(DStarLite *d, const Maze *m, int row, int col, int direction);
+size_t dstar_bytes(const DStarLite *d);
+
+//left hand rule from start facing direction until it reaches goal, loops or walks out of the maze.
+//the moves and stats are left in walk
+void wall_walk_init(WallWalk *w);
+void wall_walk_free(WallWalk *w);
+WalkResult walk_left_hand(const Maze *m, CellPos start, int direction, CellPos goal, WallWalk *w);
+size_t wall_walk_bytes(const WallWalk *w);
+
+//batch of route queries, answers in out. want_paths adds each route as runs, num_threads < 2 runs on the caller
+void route_batch_init(RouteBatch *b);
+void route_batch_free(RouteBatch *b);
+void solve_batch(const Maze *m, const RouteQuery *queries, int count, bool want_paths, int num_threads,
+                 RouteBatch *out);
+
+//false (and says why on stderr) when a rows x cols maze has too many cells to solve
+bool maze_fits_solvers(int rows, int cols);
+
+//lookup by name, NULL if there is no solver with that name
+const SolverInfo *find_solver(const char *name);
+const SolverInfo *get_solvers(int *count);
+void list_solvers(FILE *out);
+
+#endif
@@ -0,0 +1,194 @@
+#include "solver.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// a* with a manhattan distance heuristic that only stops at junctions. a cell with a single way onward
+// is just part of a corridor, so from every junction the search follows each corridor to its end in one
+// go and queues the cell it ends on (or drops it if it is a dead end). recursive division makes long
+// corridors so most cells never go through the open list. every corridor step costs 1 and the
+// heuristic drops by at most 1 per step, so it stays consistent and f never goes down, which is
+// what lets the open list be a plain array of buckets indexed by f
+
+static inline bool can_step(const Maze *m, int row, int col, int dir) {
+    int new_row = row + d_row[dir];
+    int new_col = col + d_col[dir];
+    return new_row >= 0 && new_row < m->rows && new_col >= 0 && new_col < m->cols &&
+           !maze_has_wall(m, row, col, dir);
+}
+
+static inline int manhattan(int row, int col, CellPos goal) {
+    return abs(row - goal.row) + abs(col - goal.col);
+}
+
+// ways out of (row, col) apart from back the way it was entered (going arrive_dir).
+// onward is set to one of them, which is the way to go when there is only one
+static int ways_out(const Maze *m, int row, int col, int arrive_dir, int *onward) {
+    int back = (arrive_dir + 2) % 4;
+    int count = 0;
+    for (int dir = 0; dir < 4; dir++) {
+        if (dir == back || !can_step(m, row, col, dir)) continue;
+        *onward = dir;
+        count++;
+    }
+    return count;
+}
+
+// walk from cell in direction dir until the corridor stops being a corridor: a junction, a dead end,
+// the goal or the start (the start may sit in the middle of a corridor that loops back to it).
+// fills in where it stopped, how many steps that took and the direction of the last step.
+// returns false for dead ends, nothing past one can lead to the goal
+static bool follow_corridor(const Maze *m, int cell, int dir, int start, int goal,
+                            int *end, int *steps, int *last_dir) {
+    int cols = m->cols;
+    int row = cell / cols;
+    int col = cell % cols;
+    int count = 0;
+    for (;;) {
+        row += d_row[dir];
+        col += d_col[dir];
+        count++;
+        int here = row * cols + col;
+        if (here == goal || here == start) break;
+
+        int onward;
+        int ways = ways_out(m, row, col, dir, &onward);
+        if (ways == 0) return false;
+        if (ways > 1) break;
+        dir = onward;
+    }
+    *end = row * cols + col;
+    *steps = count;
+    *last_dir = dir;
+    return true;
+}
+
+static void reserve_astar(SolverWorkspace *ws, size_t num_cells) {
+    workspace_begin(ws, num_cells); // stamps, parents and the queue used to rebuild the path
+    if (num_cells > ws->astar_capacity) {
+        free(ws->cost);
+        free(ws->step_dir);
+        ws->astar_capacity = num_cells;
+        ws->cost = (int *)malloc(sizeof(int) * num_cells);
+        ws->step_dir = (uint8_t *)malloc(num_cells);
+        if (!ws->cost || !ws->step_dir) {
+            fprintf(stderr, "Failed to allocate memory for solver workspace.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+static void push_open(SolverWorkspace *ws, int *num_entries, int cell, int cost, int f) {
+    if ((size_t)f >= ws->bucket_capacity) {
+        size_t capacity = ws->bucket_capacity ? ws->bucket_capacity : 1024;
+        while (capacity <= (size_t)f) capacity *= 2;
+        ws->bucket_head = (int *)realloc(ws->bucket_head, sizeof(int) * capacity);
+        if (!ws->bucket_head) {
+            fprintf(stderr, "Failed to reallocate memory for a* buckets.\n");
+            exit(EXIT_FAILURE);
+        }
+        for (size_t i = ws->bucket_capacity; i < capacity; i++) ws->bucket_head[i] = -1;
+        ws->bucket_capacity = capacity;
+    }
+    if ((size_t)*num_entries == ws->entry_capacity) {
+        ws->entry_capacity = ws->entry_capacity ? ws->entry_capacity * 2 : 1024;
+        ws->entries = (OpenEntry *)realloc(ws->entries, sizeof(OpenEntry) * ws->entry_capacity);
+        if (!ws->entries) {
+            fprintf(stderr, "Failed to reallocate memory for a* open list.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    // newest first within a bucket, that way ties go deeper instead of spreading out
+    ws->entries[*num_entries] = (OpenEntry){cell, cost, ws->bucket_head[f]};
+    ws->bucket_head[f] = (*num_entries)++;
+}
+
+// step_dir holds the first corridor step from the parent in the low 2 bits and the last one above that
+static void rebuild_path(const Maze *m, SolverWorkspace *ws, int start_index, int goal_index, Path *out) {
+    int cols = m->cols;
+
+    // junctions from the goal back to the start, then replay each corridor forwards
+    int count = 0;
+    for (int cell = goal_index; cell != start_index; cell = ws->parent[cell]) {
+        ws->queue[count++] = cell;
+    }
+    path_push(out, (CellPos){start_index / cols, start_index % cols});
+    int from = start_index;
+    for (int i = count - 1; i >= 0; i--) {
+        int to = ws->queue[i];
+        int row = from / cols;
+        int col = from % cols;
+        int dir = ws->step_dir[to] & 3;
+        for (;;) {
+            row += d_row[dir];
+            col += d_col[dir];
+            path_push(out, (CellPos){row, col});
+            if (row * cols + col == to) break;
+            ways_out(m, row, col, dir, &dir); // a corridor cell, exactly one way on
+        }
+        from = to;
+    }
+}
+
+bool solve_astar(const Maze *m, CellPos start, CellPos goal, SolverWorkspace *ws, Path *out) {
+    int cols = m->cols;
+    reserve_astar(ws, (size_t)m->rows * cols);
+
+    path_clear(out);
+    int start_index = start.row * cols + start.col;
+    int goal_index = goal.row * cols + goal.col;
+    int num_entries = 0;
+
+    ws->stamp[start_index] = ws->generation;
+    ws->parent[start_index] = start_index;
+    ws->cost[start_index] = 0;
+    ws->step_dir[start_index] = 0xff; // no arrival direction, every way out gets tried
+    int f = manhattan(start.row, start.col, goal);
+    int f_start = f, f_max = f;
+    push_open(ws, &num_entries, start_index, 0, f);
+
+    bool found_goal = false;
+    for (;;) {
+        while (f <= f_max && ws->bucket_head[f] < 0) f++;
+        if (f > f_max) break;
+
+        OpenEntry entry = ws->entries[ws->bucket_head[f]];
+        ws->bucket_head[f] = entry.next;
+        if (entry.cost != ws->cost[entry.cell]) continue; // found a cheaper way there since
+        out->expanded++;
+
+        if (entry.cell == goal_index) {
+            found_goal = true;
+            break;
+        }
+
+        int row = entry.cell / cols;
+        int col = entry.cell % cols;
+        int back = ws->step_dir[entry.cell] == 0xff ? -1 : ((ws->step_dir[entry.cell] >> 2) + 2) % 4;
+        for (int dir = 0; dir < 4; dir++) {
+            if (dir == back || !can_step(m, row, col, dir)) continue;
+
+            int end, steps, last_dir;
+            if (!follow_corridor(m, entry.cell, dir, start_index, goal_index, &end, &steps, &last_dir)) continue;
+
+            int cost = entry.cost + steps;
+            if (ws->stamp[end] == ws->generation && cost >= ws->cost[end]) continue;
+            ws->stamp[end] = ws->generation;
+            ws->cost[end] = cost;
+            ws->parent[end] = entry.cell;
+            ws->step_dir[end] = (uint8_t)(dir | (last_dir << 2));
+
+            int next_f = cost + manhattan(end / cols, end % cols, goal);
+            push_open(ws, &num_entries, end, cost, next_f);
+            if (next_f > f_max) f_max = next_f;
+        }
+    }
+
+    // leave the buckets empty for next time
+    for (int i = f_start; i <= f_max; i++) ws->bucket_head[i] = -1;
+
+    if (found_goal) {
+        rebuild_path(m, ws, start_index, goal_index, out);
+    }
+    return found_goal;
+}
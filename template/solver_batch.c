@@ -0,0 +1,209 @@
+#include "solver.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// many routes on the same maze at once. the queries are sorted by goal, and each goal gets one goal field
+// (solver_field.c): a bfs outward from the goal that stops as soon as it has reached every start that wants
+// that goal, so a group of queries costs at most one bfs instead of one each. the goals are handed out to
+// threads one at a time from a shared counter, and every thread has its own field and its own run buffer.
+// the answers are in query order, but the runs are the threads' buffers one after another, so a route is only
+// found through its answer's first_run
+
+#define MAX_BATCH_THREADS 64
+
+typedef struct {
+    int goal;       // goal cell, what the queries are sorted on
+    int query;
+} GoalQuery;
+
+typedef struct {
+    const Maze *m;
+    const RouteQuery *queries;
+    const GoalQuery *sorted;
+    const int *group_start;   // sorted[group_start[g] .. group_start[g + 1]) share a goal
+    int num_groups;
+    int next_group;           // claimed with an atomic add
+    bool want_paths;
+    RouteAnswer *answers;
+    int *owner;               // thread whose run buffer holds each answer's runs
+} BatchShared;
+
+typedef struct {
+    BatchShared *shared;
+    int id;
+    GoalField *field;
+    PathRun *runs;
+    size_t num_runs, run_capacity;
+    long expanded;
+} BatchThread;
+
+void route_batch_init(RouteBatch *b) {
+    memset(b, 0, sizeof(*b));
+}
+
+void route_batch_free(RouteBatch *b) {
+    free(b->answers);
+    free(b->runs);
+    for (int i = 0; i < b->num_fields; i++) goal_field_free(&b->fields[i]);
+    free(b->fields);
+    route_batch_init(b);
+}
+
+static int compare_goal(const void *a, const void *b) {
+    const GoalQuery *x = (const GoalQuery *)a;
+    const GoalQuery *y = (const GoalQuery *)b;
+    if (x->goal != y->goal) return x->goal < y->goal ? -1 : 1;
+    return x->query - y->query;
+}
+
+static void push_thread_run(BatchThread *t, PathRun run) {
+    if (t->num_runs == t->run_capacity) {
+        t->run_capacity = t->run_capacity ? t->run_capacity * 2 : 1024;
+        t->runs = (PathRun *)realloc(t->runs, sizeof(PathRun) * t->run_capacity);
+        if (!t->runs) {
+            fprintf(stderr, "Failed to reallocate memory for batch routes.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    t->runs[t->num_runs++] = run;
+}
+
+static void *batch_thread_main(void *arg) {
+    BatchThread *t = (BatchThread *)arg;
+    BatchShared *s = t->shared;
+    for (;;) {
+        int g = __atomic_fetch_add(&s->next_group, 1, __ATOMIC_RELAXED);
+        if (g >= s->num_groups) break;
+        for (int i = s->group_start[g]; i < s->group_start[g + 1]; i++) {
+            int q = s->sorted[i].query;
+            CellPos start = s->queries[q].start;
+            RouteAnswer *answer = &s->answers[q];
+            answer->first_run = (int)t->num_runs;
+            answer->num_runs = 0;
+            s->owner[q] = t->id;
+            if (!goal_field_reach(t->field, s->m, start, s->queries[q].goal, &t->expanded)) {
+                answer->distance = -1;
+                continue;
+            }
+            answer->distance = goal_field_distance(t->field, start);
+            if (!s->want_paths) continue;
+
+            RouteCursor c;
+            route_cursor_field(&c, t->field, start);
+            PathRun run;
+            while (route_cursor_next(&c, &run)) push_thread_run(t, run);
+            answer->num_runs = (int)(t->num_runs - answer->first_run);
+        }
+    }
+    return NULL;
+}
+
+void solve_batch(const Maze *m, const RouteQuery *queries, int count, bool want_paths, int num_threads,
+                 RouteBatch *out) {
+    if (count > out->answer_capacity) {
+        free(out->answers);
+        out->answer_capacity = count;
+        out->answers = (RouteAnswer *)malloc(sizeof(RouteAnswer) * count);
+        if (!out->answers) {
+            fprintf(stderr, "Failed to allocate memory for batch answers.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    out->num_runs = 0;
+    out->num_goals = 0;
+    out->expanded = 0;
+    if (count <= 0) return;
+
+    // group the queries by goal
+    GoalQuery *sorted = (GoalQuery *)malloc(sizeof(GoalQuery) * count);
+    int *group_start = (int *)malloc(sizeof(int) * (count + 1));
+    int *owner = (int *)malloc(sizeof(int) * count);
+    if (!sorted || !group_start || !owner) {
+        fprintf(stderr, "Failed to allocate memory for batch queries.\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int q = 0; q < count; q++) {
+        sorted[q] = (GoalQuery){queries[q].goal.row * m->cols + queries[q].goal.col, q};
+    }
+    qsort(sorted, count, sizeof(GoalQuery), compare_goal);
+    int num_groups = 0;
+    for (int i = 0; i < count; i++) {
+        if (i == 0 || sorted[i].goal != sorted[i - 1].goal) group_start[num_groups++] = i;
+    }
+    group_start[num_groups] = count;
+
+    // no point in more threads than goals
+    int threads = num_threads < 1 ? 1 : num_threads > MAX_BATCH_THREADS ? MAX_BATCH_THREADS : num_threads;
+    if (threads > num_groups) threads = num_groups;
+    if (threads > out->num_fields) {
+        out->fields = (GoalField *)realloc(out->fields, sizeof(GoalField) * threads);
+        if (!out->fields) {
+            fprintf(stderr, "Failed to reallocate memory for batch fields.\n");
+            exit(EXIT_FAILURE);
+        }
+        for (int i = out->num_fields; i < threads; i++) goal_field_init(&out->fields[i]);
+        out->num_fields = threads;
+    }
+    // the maze may have changed since the last batch even if it is at the same address
+    for (int i = 0; i < threads; i++) out->fields[i].bits = NULL;
+
+    BatchShared shared = {m, queries, sorted, group_start, num_groups, 0, want_paths, out->answers, owner};
+    BatchThread *workers = (BatchThread *)calloc(threads, sizeof(BatchThread));
+    pthread_t *handles = (pthread_t *)malloc(sizeof(pthread_t) * threads);
+    if (!workers || !handles) {
+        fprintf(stderr, "Failed to allocate memory for batch threads.\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < threads; i++) {
+        workers[i].shared = &shared;
+        workers[i].id = i;
+        workers[i].field = &out->fields[i];
+    }
+    // the calling thread is worker 0
+    for (int i = 1; i < threads; i++) {
+        if (pthread_create(&handles[i], NULL, batch_thread_main, &workers[i]) != 0) {
+            fprintf(stderr, "Failed to start batch thread.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    batch_thread_main(&workers[0]);
+    for (int i = 1; i < threads; i++) pthread_join(handles[i], NULL);
+
+    // one run buffer, each thread's runs after the last one's
+    size_t total = 0;
+    size_t *base = (size_t *)malloc(sizeof(size_t) * threads);
+    if (!base) {
+        fprintf(stderr, "Failed to allocate memory for batch routes.\n");
+        exit(EXIT_FAILURE);
+    }
+    for (int i = 0; i < threads; i++) {
+        base[i] = total;
+        total += workers[i].num_runs;
+        out->expanded += workers[i].expanded;
+    }
+    if (total > out->run_capacity) {
+        free(out->runs);
+        out->run_capacity = total;
+        out->runs = (PathRun *)malloc(sizeof(PathRun) * total);
+        if (!out->runs) {
+            fprintf(stderr, "Failed to allocate memory for batch routes.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    for (int i = 0; i < threads; i++) {
+        if (workers[i].num_runs) memcpy(out->runs + base[i], workers[i].runs, sizeof(PathRun) * workers[i].num_runs);
+        free(workers[i].runs);
+    }
+    for (int q = 0; q < count; q++) out->answers[q].first_run += (int)base[owner[q]];
+    out->num_runs = total;
+    out->num_goals = num_groups;
+
+    free(base);
+    free(workers);
+    free(handles);
+    free(sorted);
+    free(group_start);
+    free(owner);
+}
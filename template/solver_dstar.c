@@ -0,0 +1,206 @@
+#include "solver.h"
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// d* lite (koenig and likhachev). g is the distance to the goal as far as the search knows, rhs is what
+// the neighbours' g say it should be. a cell whose two values disagree is on the queue; settling them
+// in key order is an a* from the goal toward the start, but unlike a* everything stays around after the
+// solve. adding or removing a wall only changes rhs of the two cells next to it, so the next solve only
+// works through the cells whose distance really changed instead of searching the maze again.
+// the heap is lazy: stale entries stay in it and are skipped when they come out
+
+#define DSTAR_INF (INT_MAX / 4)
+
+void dstar_init(DStarLite *d) {
+    memset(d, 0, sizeof(*d));
+}
+
+void dstar_free(DStarLite *d) {
+    free(d->g);
+    free(d->rhs);
+    free(d->heap);
+    dstar_init(d);
+}
+
+size_t dstar_bytes(const DStarLite *d) {
+    return d->cell_capacity * sizeof(int) * 2 + d->heap_capacity * sizeof(DStarEntry);
+}
+
+static inline int heuristic(const DStarLite *d, int a, int b) {
+    return abs(a / d->cols - b / d->cols) + abs(a % d->cols - b % d->cols);
+}
+
+static inline bool key_less(DStarEntry a, DStarEntry b) {
+    return a.key < b.key;
+}
+
+// [min(g, rhs) + h + km, min(g, rhs)], compared first part first
+static inline DStarEntry key_of(const DStarLite *d, int cell) {
+    int best = d->g[cell] < d->rhs[cell] ? d->g[cell] : d->rhs[cell];
+    uint64_t first = (uint64_t)(best + heuristic(d, d->last_start, cell) + d->km);
+    return (DStarEntry){first << 32 | (uint32_t)best, cell};
+}
+
+static void heap_push(DStarLite *d, DStarEntry entry) {
+    if (d->heap_size == d->heap_capacity) {
+        d->heap_capacity = d->heap_capacity ? d->heap_capacity * 2 : 1024;
+        d->heap = (DStarEntry *)realloc(d->heap, sizeof(DStarEntry) * d->heap_capacity);
+        if (!d->heap) {
+            fprintf(stderr, "Failed to reallocate memory for d* lite queue.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    size_t i = d->heap_size++;
+    while (i > 0 && key_less(entry, d->heap[(i - 1) / 2])) {
+        d->heap[i] = d->heap[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    d->heap[i] = entry;
+}
+
+static DStarEntry heap_pop(DStarLite *d) {
+    DStarEntry top = d->heap[0];
+    DStarEntry last = d->heap[--d->heap_size];
+    size_t i = 0;
+    for (;;) {
+        size_t child = 2 * i + 1;
+        if (child >= d->heap_size) break;
+        if (child + 1 < d->heap_size && key_less(d->heap[child + 1], d->heap[child])) child++;
+        if (!key_less(d->heap[child], last)) break;
+        d->heap[i] = d->heap[child];
+        i = child;
+    }
+    if (d->heap_size > 0) d->heap[i] = last;
+    return top;
+}
+
+// neighbours of cell that arent behind a wall, returns how many
+static int open_neighbours(const DStarLite *d, const Maze *m, int cell, int *out) {
+    int row = cell / d->cols, col = cell % d->cols;
+    int count = 0;
+    for (int dir = 0; dir < 4; dir++) {
+        int new_row = row + d_row[dir], new_col = col + d_col[dir];
+        if (new_row < 0 || new_row >= d->rows || new_col < 0 || new_col >= d->cols) continue;
+        if (maze_has_wall(m, row, col, dir)) continue;
+        out[count++] = new_row * d->cols + new_col;
+    }
+    return count;
+}
+
+// work out rhs again from the neighbours and queue the cell if it no longer agrees with g
+static void update_cell(DStarLite *d, const Maze *m, int cell) {
+    if (cell != d->goal) {
+        int next[4];
+        int count = open_neighbours(d, m, cell, next);
+        int rhs = DSTAR_INF;
+        for (int i = 0; i < count; i++) {
+            if (d->g[next[i]] + 1 < rhs) rhs = d->g[next[i]] + 1;
+        }
+        d->rhs[cell] = rhs;
+    }
+    if (d->g[cell] != d->rhs[cell]) heap_push(d, key_of(d, cell));
+}
+
+static void start_search(DStarLite *d, const Maze *m, int start, int goal) {
+    size_t num_cells = (size_t)m->rows * m->cols;
+    if (num_cells > d->cell_capacity) {
+        free(d->g);
+        free(d->rhs);
+        d->cell_capacity = num_cells;
+        d->g = (int *)malloc(sizeof(int) * num_cells);
+        d->rhs = (int *)malloc(sizeof(int) * num_cells);
+        if (!d->g || !d->rhs) {
+            fprintf(stderr, "Failed to allocate memory for d* lite.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    for (size_t i = 0; i < num_cells; i++) {
+        d->g[i] = DSTAR_INF;
+        d->rhs[i] = DSTAR_INF;
+    }
+    d->bits = m->bits;
+    d->rows = m->rows;
+    d->cols = m->cols;
+    d->goal = goal;
+    d->last_start = start;
+    d->km = 0;
+    d->heap_size = 0;
+    d->rhs[goal] = 0;
+    heap_push(d, key_of(d, goal));
+}
+
+// settle cells until start is settled and nothing left on the queue could still beat it.
+// returns how many cells it settled
+static long settle(DStarLite *d, const Maze *m) {
+    int start = d->last_start;
+    long settled = 0;
+    while (d->heap_size > 0 &&
+           (key_less(d->heap[0], key_of(d, start)) || d->g[start] != d->rhs[start])) {
+        DStarEntry old = heap_pop(d);
+        int cell = old.cell;
+        if (d->g[cell] == d->rhs[cell]) continue; // settled since it was queued
+        DStarEntry now = key_of(d, cell);
+        if (key_less(old, now)) {
+            heap_push(d, now); // its key went up (start moved or g changed), back in line
+            continue;
+        }
+        settled++;
+
+        int next[4];
+        int count = open_neighbours(d, m, cell, next);
+        if (d->g[cell] > d->rhs[cell]) {
+            d->g[cell] = d->rhs[cell];
+        } else {
+            // it got further away, everything that went through it has to look again
+            d->g[cell] = DSTAR_INF;
+            update_cell(d, m, cell);
+        }
+        for (int i = 0; i < count; i++) update_cell(d, m, next[i]);
+    }
+    return settled;
+}
+
+void dstar_wall_changed(DStarLite *d, const Maze *m, int row, int col, int direction) {
+    if (d->bits != m->bits || d->rows != m->rows || d->cols != m->cols) return; // nothing to repair
+    int new_row = row + d_row[direction], new_col = col + d_col[direction];
+    update_cell(d, m, row * d->cols + col);
+    if (new_row >= 0 && new_row < d->rows && new_col >= 0 && new_col < d->cols) {
+        update_cell(d, m, new_row * d->cols + new_col);
+    }
+}
+
+bool solve_dstar(const Maze *m, CellPos start, CellPos goal, SolverWorkspace *ws, Path *out) {
+    DStarLite *d = &ws->dstar;
+    int from = start.row * m->cols + start.col;
+    int to = goal.row * m->cols + goal.col;
+    if (d->bits != m->bits || d->rows != m->rows || d->cols != m->cols || d->goal != to) {
+        start_search(d, m, from, to);
+    } else if (from != d->last_start) {
+        // every key still on the queue was worked out from the old start, km makes up the difference
+        d->km += heuristic(d, d->last_start, from);
+        d->last_start = from;
+    }
+
+    path_clear(out);
+    out->expanded = settle(d, m);
+    if (d->g[from] >= DSTAR_INF) return false;
+
+    // downhill from the start, every step goes to a neighbour one closer to the goal
+    path_reserve(out, d->g[from] + 1);
+    int cell = from;
+    path_push(out, start);
+    while (cell != to) {
+        int next[4];
+        int count = open_neighbours(d, m, cell, next);
+        int best = -1;
+        for (int i = 0; i < count; i++) {
+            if (best < 0 || d->g[next[i]] < d->g[best]) best = next[i];
+        }
+        if (best < 0 || d->g[best] >= d->g[cell]) return false; // cant happen once start is settled
+        cell = best;
+        path_push(out, (CellPos){cell / m->cols, cell % m->cols});
+    }
+    return true;
+}
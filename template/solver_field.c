@@ -0,0 +1,132 @@
+#include "solver.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// solving by following a distance field. the goal (the exit for the 'z' key) never moves, so instead of
+// searching from the player every time this runs one bfs outward from the goal and keeps what it found:
+// for every cell, how far it is and which neighbour is one step closer. a solve from a cell the bfs
+// already reached is just walking those steps, O(path length). when it hasnt got there yet the bfs
+// picks up from where it stopped last time and runs until it does, so nothing is ever searched twice
+
+void goal_field_init(GoalField *f) {
+    memset(f, 0, sizeof(*f));
+}
+
+void goal_field_free(GoalField *f) {
+    free(f->toward);
+    free(f->dist);
+    free(f->queue);
+    goal_field_init(f);
+}
+
+size_t goal_field_bytes(const GoalField *f) {
+    return f->cell_capacity * (sizeof(uint8_t) + sizeof(int) * 2);
+}
+
+// throw away what the field had and start a new bfs from goal
+static void field_reset(GoalField *f, const Maze *m, CellPos goal) {
+    size_t num_cells = (size_t)m->rows * m->cols;
+    if (num_cells > f->cell_capacity) {
+        free(f->toward);
+        free(f->dist);
+        free(f->queue);
+        f->cell_capacity = num_cells;
+        f->toward = (uint8_t *)malloc(num_cells);
+        f->dist = (int *)malloc(sizeof(int) * num_cells);
+        f->queue = (int *)malloc(sizeof(int) * num_cells);
+        if (!f->toward || !f->dist || !f->queue) {
+            fprintf(stderr, "Failed to allocate memory for goal field.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    memset(f->toward, FIELD_UNREACHED, num_cells);
+
+    f->bits = m->bits;
+    f->rows = m->rows;
+    f->cols = m->cols;
+    f->goal = goal.row * m->cols + goal.col;
+    f->toward[f->goal] = FIELD_GOAL;
+    f->dist[f->goal] = 0;
+    f->front = 0;
+    f->back = 0;
+    f->queue[f->back++] = f->goal;
+}
+
+// carry on with the bfs until it reaches stop (or covers the maze if stop is -1).
+// every cell it takes off the queue is counted in *expanded
+static void field_extend(GoalField *f, const Maze *m, int stop, long *expanded) {
+    int rows = f->rows;
+    int cols = f->cols;
+    uint8_t *toward = f->toward;
+    int *dist = f->dist;
+    int *queue = f->queue;
+    size_t front = f->front, back = f->back;
+
+    // a cell only stops the bfs once all of its neighbours are queued, so the next call can just
+    // continue from front
+    while (front < back && (stop < 0 || toward[stop] == FIELD_UNREACHED)) {
+        int current = queue[front++];
+        (*expanded)++;
+
+        int row = current / cols;
+        int col = current % cols;
+        for (int dir = 0; dir < 4; dir++) {
+            int new_row = row + d_row[dir];
+            int new_col = col + d_col[dir];
+            if (new_row < 0 || new_row >= rows || new_col < 0 || new_col >= cols) continue;
+            if (maze_has_wall(m, row, col, dir)) continue;
+
+            int next = new_row * cols + new_col;
+            if (toward[next] != FIELD_UNREACHED) continue;
+            toward[next] = (uint8_t)((dir + 2) % 4); // back the way the bfs came
+            dist[next] = dist[current] + 1;
+            queue[back++] = next;
+        }
+    }
+    f->front = front;
+    f->back = back;
+}
+
+static bool field_matches(const GoalField *f, const Maze *m, CellPos goal) {
+    return f->bits == m->bits && f->rows == m->rows && f->cols == m->cols &&
+           f->goal == goal.row * m->cols + goal.col;
+}
+
+void goal_field_build(GoalField *f, const Maze *m, CellPos goal) {
+    if (!field_matches(f, m, goal)) field_reset(f, m, goal);
+    long expanded = 0;
+    field_extend(f, m, -1, &expanded);
+}
+
+int goal_field_distance(const GoalField *f, CellPos cell) {
+    if (!f->bits) return -1;
+    int index = cell.row * f->cols + cell.col;
+    return f->toward[index] == FIELD_UNREACHED ? -1 : f->dist[index];
+}
+
+bool goal_field_reach(GoalField *f, const Maze *m, CellPos from, CellPos goal, long *expanded) {
+    if (!field_matches(f, m, goal)) field_reset(f, m, goal);
+    int cell = from.row * m->cols + from.col;
+    if (f->toward[cell] == FIELD_UNREACHED) field_extend(f, m, cell, expanded);
+    return f->toward[cell] != FIELD_UNREACHED;
+}
+
+bool solve_field(const Maze *m, CellPos start, CellPos goal, SolverWorkspace *ws, Path *out) {
+    GoalField *f = &ws->field;
+    path_clear(out);
+    if (!goal_field_reach(f, m, start, goal, &out->expanded)) return false;
+    int cell = start.row * m->cols + start.col;
+
+    // the distance says how long the path is, so it only grows once
+    path_reserve(out, f->dist[cell] + 1);
+    for (;;) {
+        int row = cell / m->cols;
+        int col = cell % m->cols;
+        out->cells[out->length++] = (CellPos){row, col};
+        int dir = f->toward[cell];
+        if (dir == FIELD_GOAL) break;
+        cell = (row + d_row[dir]) * m->cols + col + d_col[dir];
+    }
+    return true;
+}
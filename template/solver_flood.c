@@ -0,0 +1,403 @@
+#include "solver.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define FLOOD_HAVE_AVX2 1
+#endif
+
+// bfs done on whole words of cells at a time. the frontier is a bitplane with the same layout as the
+// maze rows, and one level is a handful of shifts and masks against the wall planes: east/west moves
+// shift the row by one bit and drop anything that hits a west wall bit, north/south moves take the
+// row above or below and drop anything under a north wall bit. a frontier in a maze is sparse, even
+// inside one row its cells can be far apart, so every row also has a summary with one bit per word
+// that isnt zero and only those words (in rows that have any) get touched.
+// there are no parents, instead every visited cell is marked in one of three planes by distance % 3.
+// the neighbour one step closer to the start is the only one with (d - 1) % 3, so the path is
+// walked back from the goal with that. in a perfect maze it is the same path bfs finds, with loops
+// it is a shortest path too but ties can go a different way than bfs's queue order
+
+enum { VISITED, FRONTIER, NEXT, LEVEL0, LEVEL1, LEVEL2, NUM_PLANES };
+
+// one frontier row spreading into the next frontier
+typedef struct {
+    const uint64_t *frontier;
+    const uint64_t *north, *north_below;     // north walls of this row and the row below
+    const uint64_t *west;
+    uint64_t *up, *here, *down;              // next frontier rows, up/down point at a spare row at the edges
+} PushRow;
+
+// one next frontier row being checked against visited
+typedef struct {
+    uint64_t *next, *visited;
+    uint64_t *mark, *clear_a, *clear_b;      // level plane for this distance and the other two
+} CommitRow;
+
+typedef void (*PushFn)(const PushRow *r, int lo, int hi, int words);
+typedef long (*CommitFn)(const CommitRow *r, int lo, int hi);
+
+// cells of word w that step east or west out of the frontier row
+static inline uint64_t sideways(const PushRow *r, int w, int words) {
+    uint64_t f = r->frontier[w];
+    uint64_t left = w > 0 ? r->frontier[w - 1] : 0;
+    uint64_t right = w + 1 < words ? r->frontier[w + 1] & ~r->west[w + 1] : 0;
+    uint64_t east = ((f << 1) | (left >> 63)) & ~r->west[w];
+    uint64_t west = ((f & ~r->west[w]) >> 1) | (right << 63);
+    return east | west;
+}
+
+// frontier words lo..hi move into words lo..hi of the rows above and below, and one word further
+// either side in their own row
+static void push_scalar(const PushRow *r, int lo, int hi, int words) {
+    int a = lo > 0 ? lo - 1 : lo;
+    int b = hi + 1 < words ? hi + 1 : hi;
+    for (int w = a; w <= b; w++) r->here[w] |= sideways(r, w, words);
+    for (int w = lo; w <= hi; w++) {
+        r->up[w] |= r->frontier[w] & ~r->north[w];
+        r->down[w] |= r->frontier[w] & ~r->north_below[w];
+    }
+}
+
+static inline long commit_word(const CommitRow *r, int w) {
+    uint64_t n = r->next[w] & ~r->visited[w];
+    r->next[w] = n;
+    r->visited[w] |= n;
+    r->mark[w] |= n;
+    r->clear_a[w] &= ~n;
+    r->clear_b[w] &= ~n;
+    return __builtin_popcountll(n);
+}
+
+// drops cells that were already visited and marks the rest, returns how many are left
+static long commit_scalar(const CommitRow *r, int lo, int hi) {
+    long count = 0;
+    for (int w = lo; w <= hi; w++) count += commit_word(r, w);
+    return count;
+}
+
+#ifdef FLOOD_HAVE_AVX2
+#define LOAD(p) _mm256_loadu_si256((const __m256i *)(p))
+#define STORE(p, v) _mm256_storeu_si256((__m256i *)(p), (v))
+
+// same things 4 words at a time, the words at the ends of the row are left to the scalar code
+__attribute__((target("avx2,popcnt")))
+static void push_avx2(const PushRow *r, int lo, int hi, int words) {
+    int a = lo > 0 ? lo - 1 : lo;
+    int b = hi + 1 < words ? hi + 1 : hi;
+    int w = a;
+    if (w == 0 && w <= b) {
+        r->here[w] |= sideways(r, w, words);
+        w++;
+    }
+    for (; w + 3 <= b && w + 4 < words; w += 4) {
+        __m256i f = LOAD(r->frontier + w);
+        __m256i left = LOAD(r->frontier + w - 1);
+        __m256i right = _mm256_andnot_si256(LOAD(r->west + w + 1), LOAD(r->frontier + w + 1));
+        __m256i wall = LOAD(r->west + w);
+        __m256i east = _mm256_andnot_si256(wall, _mm256_or_si256(_mm256_slli_epi64(f, 1), _mm256_srli_epi64(left, 63)));
+        __m256i west = _mm256_or_si256(_mm256_srli_epi64(_mm256_andnot_si256(wall, f), 1), _mm256_slli_epi64(right, 63));
+        STORE(r->here + w, _mm256_or_si256(LOAD(r->here + w), _mm256_or_si256(east, west)));
+    }
+    for (; w <= b; w++) r->here[w] |= sideways(r, w, words);
+
+    for (w = lo; w + 3 <= hi; w += 4) {
+        __m256i f = LOAD(r->frontier + w);
+        STORE(r->up + w, _mm256_or_si256(LOAD(r->up + w), _mm256_andnot_si256(LOAD(r->north + w), f)));
+        STORE(r->down + w, _mm256_or_si256(LOAD(r->down + w), _mm256_andnot_si256(LOAD(r->north_below + w), f)));
+    }
+    for (; w <= hi; w++) {
+        r->up[w] |= r->frontier[w] & ~r->north[w];
+        r->down[w] |= r->frontier[w] & ~r->north_below[w];
+    }
+}
+
+__attribute__((target("avx2,popcnt")))
+static long commit_avx2(const CommitRow *r, int lo, int hi) {
+    long count = 0;
+    int w = lo;
+    for (; w + 3 <= hi; w += 4) {
+        __m256i visited = LOAD(r->visited + w);
+        __m256i n = _mm256_andnot_si256(visited, LOAD(r->next + w));
+        STORE(r->next + w, n);
+        STORE(r->visited + w, _mm256_or_si256(visited, n));
+        STORE(r->mark + w, _mm256_or_si256(LOAD(r->mark + w), n));
+        STORE(r->clear_a + w, _mm256_andnot_si256(n, LOAD(r->clear_a + w)));
+        STORE(r->clear_b + w, _mm256_andnot_si256(n, LOAD(r->clear_b + w)));
+        count += __builtin_popcountll(r->next[w]) + __builtin_popcountll(r->next[w + 1]) +
+                 __builtin_popcountll(r->next[w + 2]) + __builtin_popcountll(r->next[w + 3]);
+    }
+    for (; w <= hi; w++) count += commit_word(r, w);
+    return count;
+}
+
+#undef LOAD
+#undef STORE
+#endif
+
+static PushFn push_run = NULL;
+static CommitFn commit_run = NULL;
+
+static bool cpu_has_avx2(void) {
+#ifdef FLOOD_HAVE_AVX2
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt");
+#else
+    return false;
+#endif
+}
+
+bool flood_use_avx2(bool enable) {
+#ifdef FLOOD_HAVE_AVX2
+    if (enable && cpu_has_avx2()) {
+        push_run = push_avx2;
+        commit_run = commit_avx2;
+        return true;
+    }
+#endif
+    push_run = push_scalar;
+    commit_run = commit_scalar;
+    return false;
+}
+
+// words of the per row summary
+static inline int summary_words(int words) {
+    return (words + 63) / 64;
+}
+
+static void reserve_flood(SolverWorkspace *ws, int rows, int words) {
+    size_t plane_words = (size_t)rows * words;
+    size_t summary_plane = (size_t)rows * summary_words(words);
+    size_t total = plane_words * NUM_PLANES + words + 2 * summary_plane;
+    if (total > ws->flood_words) {
+        free(ws->flood_bits);
+        ws->flood_words = total;
+        ws->flood_bits = (uint64_t *)malloc(sizeof(uint64_t) * total);
+        if (!ws->flood_bits) {
+            fprintf(stderr, "Failed to allocate memory for solver workspace.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    if ((size_t)rows > ws->flood_row_capacity) {
+        free(ws->flood_rows);
+        ws->flood_row_capacity = rows;
+        ws->flood_rows = (int *)malloc(sizeof(int) * 3 * rows);
+        if (!ws->flood_rows) {
+            fprintf(stderr, "Failed to allocate memory for solver workspace.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    // the level planes are only ever read for visited cells so they can keep old bits,
+    // everything else starts out zero
+    memset(ws->flood_bits, 0, sizeof(uint64_t) * plane_words * LEVEL0);
+    memset(ws->flood_bits + plane_words * NUM_PLANES + words, 0, sizeof(uint64_t) * 2 * summary_plane);
+    memset(ws->flood_rows + 2 * rows, 0, sizeof(int) * rows);
+}
+
+// set the summary bits of the words in lo..hi that have something in them
+static inline bool mark_words(uint64_t *summary, const uint64_t *row, int lo, int hi) {
+    bool any = false;
+    for (int w = lo; w <= hi; w++) {
+        if (!row[w]) continue;
+        summary[w / 64] |= 1ULL << (w % 64);
+        any = true;
+    }
+    return any;
+}
+
+// finds the first run of set bits in a row summary at or after bit from, as a range of words.
+// false when there are none left
+static inline bool next_run(const uint64_t *summary, int sw, int from, int *lo, int *hi) {
+    int j = from / 64;
+    if (j >= sw) return false;
+    uint64_t bits = summary[j] & (~0ULL << (from % 64));
+    while (!bits) {
+        if (++j == sw) return false;
+        bits = summary[j];
+    }
+    *lo = j * 64 + __builtin_ctzll(bits);
+
+    uint64_t gaps = ~summary[j] & (~0ULL << (*lo % 64));
+    while (!gaps) {
+        if (++j == sw) {
+            *hi = sw * 64 - 1;
+            return true;
+        }
+        gaps = ~summary[j];
+    }
+    *hi = j * 64 + __builtin_ctzll(gaps) - 1;
+    return true;
+}
+
+// floods out from start until goal turns up, returns its distance or -1. expanded gets the number of
+// cells reached, the level planes are left behind for rebuild_path
+static int flood(const Maze *m, CellPos start, CellPos goal, SolverWorkspace *ws, long *expanded) {
+    if (!push_run) flood_use_avx2(true);
+
+    int rows = m->rows;
+    int words = m->words_per_plane;
+    int sw = summary_words(words);
+    size_t plane_words = (size_t)rows * words;
+    reserve_flood(ws, rows, words);
+
+    uint64_t *visited = ws->flood_bits;
+    uint64_t *frontier = ws->flood_bits + plane_words * FRONTIER;
+    uint64_t *next = ws->flood_bits + plane_words * NEXT;
+    uint64_t *level = ws->flood_bits + plane_words * LEVEL0;
+    uint64_t *spare = ws->flood_bits + plane_words * NUM_PLANES; // moves off the edge land here
+    uint64_t *summary = spare + words;
+    uint64_t *next_summary = summary + (size_t)rows * sw;
+
+    // rows the frontier is in and rows the next one got something in
+    int *active = ws->flood_rows;
+    int *touched = ws->flood_rows + rows;
+    int *queued = ws->flood_rows + 2 * rows;
+
+    int start_word = start.col / 64;
+    uint64_t start_bit = 1ULL << (start.col % 64);
+    size_t start_offset = (size_t)start.row * words + start_word;
+    frontier[start_offset] = start_bit;
+    visited[start_offset] = start_bit;
+    level[start_offset] |= start_bit;
+    level[plane_words + start_offset] &= ~start_bit;
+    level[2 * plane_words + start_offset] &= ~start_bit;
+    summary[(size_t)start.row * sw + start_word / 64] = 1ULL << (start_word % 64);
+    int num_active = 1;
+    active[0] = start.row;
+    *expanded = 1;
+
+    size_t goal_offset = (size_t)goal.row * words + goal.col / 64;
+    uint64_t goal_bit = 1ULL << (goal.col % 64);
+    int distance = 0;
+    bool found_goal = (start.row == goal.row && start.col == goal.col);
+
+    while (!found_goal && num_active > 0) {
+        distance++;
+
+        // spread every frontier row into next, remembering which words got anything
+        int num_touched = 0;
+        for (int i = 0; i < num_active; i++) {
+            int r = active[i];
+            size_t offset = (size_t)r * words;
+            PushRow row;
+            row.frontier = frontier + offset;
+            row.north = maze_north_row(m, r);
+            row.north_below = maze_north_row(m, r + 1); // the south border row for the last one
+            row.west = maze_west_row(m, r);
+            row.up = r > 0 ? next + offset - words : spare;
+            row.here = next + offset;
+            row.down = r + 1 < rows ? next + offset + words : spare;
+
+            const uint64_t *s = summary + (size_t)r * sw;
+            for (int lo, hi, from = 0; next_run(s, sw, from, &lo, &hi); from = hi + 1) {
+                push_run(&row, lo, hi, words);
+                int a = lo > 0 ? lo - 1 : lo;
+                int b = hi + 1 < words ? hi + 1 : hi;
+                if (mark_words(next_summary + (size_t)r * sw, row.here, a, b) && !queued[r]) {
+                    queued[r] = 1;
+                    touched[num_touched++] = r;
+                }
+                if (r > 0 && mark_words(next_summary + (size_t)(r - 1) * sw, row.up, lo, hi) && !queued[r - 1]) {
+                    queued[r - 1] = 1;
+                    touched[num_touched++] = r - 1;
+                }
+                if (r + 1 < rows && mark_words(next_summary + (size_t)(r + 1) * sw, row.down, lo, hi) &&
+                    !queued[r + 1]) {
+                    queued[r + 1] = 1;
+                    touched[num_touched++] = r + 1;
+                }
+            }
+        }
+
+        // the old frontier goes back to zero, it is the next buffer for the level after this
+        for (int i = 0; i < num_active; i++) {
+            uint64_t *s = summary + (size_t)active[i] * sw;
+            uint64_t *f = frontier + (size_t)active[i] * words;
+            for (int j = 0; j < sw; j++) {
+                for (uint64_t bits = s[j]; bits; bits &= bits - 1) f[j * 64 + __builtin_ctzll(bits)] = 0;
+                s[j] = 0;
+            }
+        }
+
+        // keep only cells that havent been visited, rows that end up empty drop out
+        int k = distance % 3;
+        int num_next = 0;
+        for (int i = 0; i < num_touched; i++) {
+            int r = touched[i];
+            queued[r] = 0;
+            size_t offset = (size_t)r * words;
+            CommitRow row;
+            row.next = next + offset;
+            row.visited = visited + offset;
+            row.mark = level + plane_words * k + offset;
+            row.clear_a = level + plane_words * ((k + 1) % 3) + offset;
+            row.clear_b = level + plane_words * ((k + 2) % 3) + offset;
+
+            uint64_t *s = next_summary + (size_t)r * sw;
+            long count = 0;
+            for (int lo, hi, from = 0; next_run(s, sw, from, &lo, &hi); from = hi + 1) {
+                count += commit_run(&row, lo, hi);
+                for (int w = lo; w <= hi; w++) {
+                    if (!row.next[w]) s[w / 64] &= ~(1ULL << (w % 64));
+                }
+            }
+            if (count == 0) continue;
+            *expanded += count;
+            active[num_next++] = r;
+        }
+        if (next[goal_offset] & goal_bit) found_goal = true;
+
+        uint64_t *swap = frontier;
+        frontier = next;
+        next = swap;
+        swap = summary;
+        summary = next_summary;
+        next_summary = swap;
+        num_active = num_next;
+    }
+    return found_goal ? distance : -1;
+}
+
+// cells with distance % 3 == d % 3 are in plane d % 3
+static inline bool at_level(const uint64_t *level, size_t plane_words, int words, int distance, int row, int col) {
+    const uint64_t *plane = level + plane_words * (distance % 3) + (size_t)row * words;
+    return maze_get_bit(plane, col);
+}
+
+// walk back from the goal, every step goes to the open neighbour one level closer to the start
+static void rebuild_path(const Maze *m, SolverWorkspace *ws, CellPos goal, int distance, Path *out) {
+    int words = m->words_per_plane;
+    size_t plane_words = (size_t)m->rows * words;
+    const uint64_t *visited = ws->flood_bits;
+    const uint64_t *level = ws->flood_bits + plane_words * LEVEL0;
+
+    CellPos cell = goal;
+    path_push(out, cell);
+    for (int d = distance; d > 0; d--) {
+        for (int dir = 0; dir < 4; dir++) {
+            int row = cell.row + d_row[dir];
+            int col = cell.col + d_col[dir];
+            if (row < 0 || row >= m->rows || col < 0 || col >= m->cols) continue;
+            if (maze_has_wall(m, cell.row, cell.col, dir)) continue;
+            if (!maze_get_bit(visited + (size_t)row * words, col)) continue;
+            if (!at_level(level, plane_words, words, d - 1, row, col)) continue;
+            cell = (CellPos){row, col};
+            break;
+        }
+        path_push(out, cell);
+    }
+    path_reverse(out);
+}
+
+int flood_distance(const Maze *m, CellPos start, CellPos goal, SolverWorkspace *ws) {
+    long expanded;
+    return flood(m, start, goal, ws, &expanded);
+}
+
+bool solve_flood(const Maze *m, CellPos start, CellPos goal, SolverWorkspace *ws, Path *out) {
+    path_clear(out);
+    int distance = flood(m, start, goal, ws, &out->expanded);
+    if (distance < 0) return false;
+    rebuild_path(m, ws, goal, distance, out);
+    return true;
+}
@@ -0,0 +1,313 @@
+#include "solver.h"
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// hierarchical pathfinding. the index is a graph over the tile edges: a node for every cell that has an
+// open passage into the next tile, an edge of cost 1 across that passage and an edge between every two
+// nodes of the same tile that can reach each other inside it, weighted by that distance. every path
+// through the maze breaks up into pieces inside single tiles, so a* over this graph gives the same
+// length as a bfs over the whole maze. a solve only touches the maze itself in the start and goal tiles
+// (to hook them up to the graph) and in the tiles the route goes through (to fill in the cells)
+
+void hpa_index_init(HpaIndex *h) {
+    memset(h, 0, sizeof(*h));
+}
+
+void hpa_index_free(HpaIndex *h) {
+    free(h->tile_first);
+    free(h->node_cell);
+    free(h->edge_start);
+    free(h->edges);
+    free(h->cost);
+    free(h->prev);
+    free(h->stamp);
+    free(h->heap);
+    free(h->chain);
+    hpa_index_init(h);
+}
+
+size_t hpa_index_bytes(const HpaIndex *h) {
+    size_t bytes = h->tile_capacity * sizeof(int);
+    bytes += (size_t)h->node_capacity * (sizeof(int) * 5 + sizeof(uint32_t));
+    bytes += h->edge_capacity * sizeof(HpaEdge);
+    bytes += h->heap_capacity * sizeof(HeapEntry);
+    return bytes;
+}
+
+static void *grow(void *p, size_t bytes) {
+    p = realloc(p, bytes);
+    if (!p) {
+        fprintf(stderr, "Failed to reallocate memory for hpa index.\n");
+        exit(EXIT_FAILURE);
+    }
+    return p;
+}
+
+static inline int tile_of(const HpaIndex *h, int row, int col) {
+    return row / HPA_TILE * h->tiles_x + col / HPA_TILE;
+}
+
+// position of a cell inside its tile
+static inline int local_index(int row, int col) {
+    return row % HPA_TILE * HPA_TILE + col % HPA_TILE;
+}
+
+// bfs from cell that never leaves its tile, fills local_dist (-1 where it didnt get) and local_up
+static void tile_bfs(HpaIndex *h, const Maze *m, int cell) {
+    int row = cell / m->cols, col = cell % m->cols;
+    int top = row - row % HPA_TILE, left = col - col % HPA_TILE;
+    int bottom = top + HPA_TILE < m->rows ? top + HPA_TILE : m->rows;
+    int right = left + HPA_TILE < m->cols ? left + HPA_TILE : m->cols;
+
+    memset(h->local_dist, -1, sizeof(h->local_dist));
+    int front = 0, back = 0;
+    int start = local_index(row, col);
+    h->local_dist[start] = 0;
+    h->local_queue[back++] = start;
+    while (front < back) {
+        int current = h->local_queue[front++];
+        int r = top + current / HPA_TILE, c = left + current % HPA_TILE;
+        for (int dir = 0; dir < 4; dir++) {
+            int new_row = r + d_row[dir], new_col = c + d_col[dir];
+            if (new_row < top || new_row >= bottom || new_col < left || new_col >= right) continue;
+            if (maze_has_wall(m, r, c, dir)) continue;
+            int next = local_index(new_row, new_col);
+            if (h->local_dist[next] >= 0) continue;
+            h->local_dist[next] = h->local_dist[current] + 1;
+            h->local_up[next] = (uint8_t)((dir + 2) % 4);
+            h->local_queue[back++] = next;
+        }
+    }
+}
+
+// whether the passage from cell in direction dir is open and leads into another tile
+static bool crosses(const Maze *m, int row, int col, int dir) {
+    int new_row = row + d_row[dir], new_col = col + d_col[dir];
+    if (new_row < 0 || new_row >= m->rows || new_col < 0 || new_col >= m->cols) return false;
+    if (new_row / HPA_TILE == row / HPA_TILE && new_col / HPA_TILE == col / HPA_TILE) return false;
+    return !maze_has_wall(m, row, col, dir);
+}
+
+// node id of cell, which has to be one of the nodes of its tile
+static int find_node(const HpaIndex *h, int cell, int cols) {
+    int tile = tile_of(h, cell / cols, cell % cols);
+    for (int n = h->tile_first[tile]; n < h->tile_first[tile + 1]; n++) {
+        if (h->node_cell[n] == cell) return n;
+    }
+    return -1;
+}
+
+static void add_edge(HpaIndex *h, int to, int cost) {
+    if (h->num_edges == h->edge_capacity) {
+        h->edge_capacity = h->edge_capacity ? h->edge_capacity * 2 : 4096;
+        h->edges = (HpaEdge *)grow(h->edges, sizeof(HpaEdge) * h->edge_capacity);
+    }
+    h->edges[h->num_edges++] = (HpaEdge){to, cost};
+}
+
+void hpa_index_build(HpaIndex *h, const Maze *m) {
+    h->tiles_x = (m->cols + HPA_TILE - 1) / HPA_TILE;
+    h->tiles_y = (m->rows + HPA_TILE - 1) / HPA_TILE;
+    size_t num_tiles = (size_t)h->tiles_x * h->tiles_y;
+    if (num_tiles + 1 > h->tile_capacity) {
+        h->tile_capacity = num_tiles + 1;
+        h->tile_first = (int *)grow(h->tile_first, sizeof(int) * h->tile_capacity);
+    }
+
+    // nodes, tile by tile so each tile's nodes are next to each other
+    h->num_nodes = 0;
+    for (int tile = 0; tile < (int)num_tiles; tile++) {
+        h->tile_first[tile] = h->num_nodes;
+        int top = tile / h->tiles_x * HPA_TILE, left = tile % h->tiles_x * HPA_TILE;
+        int bottom = top + HPA_TILE < m->rows ? top + HPA_TILE : m->rows;
+        int right = left + HPA_TILE < m->cols ? left + HPA_TILE : m->cols;
+        for (int row = top; row < bottom; row++) {
+            for (int col = left; col < right; col++) {
+                // only the edge of the tile can have passages out of it
+                if (row != top && row != bottom - 1 && col != left && col != right - 1) continue;
+                bool node = false;
+                for (int dir = 0; dir < 4; dir++) node = node || crosses(m, row, col, dir);
+                if (!node) continue;
+                if (h->num_nodes == h->node_capacity) {
+                    h->node_capacity = h->node_capacity ? h->node_capacity * 2 : 1024;
+                    h->node_cell = (int *)grow(h->node_cell, sizeof(int) * h->node_capacity);
+                }
+                h->node_cell[h->num_nodes++] = row * m->cols + col;
+            }
+        }
+    }
+    h->tile_first[num_tiles] = h->num_nodes;
+
+    size_t node_bytes = sizeof(int) * (h->node_capacity + 1);
+    h->edge_start = (int *)grow(h->edge_start, node_bytes);
+    h->cost = (int *)grow(h->cost, node_bytes);
+    h->prev = (int *)grow(h->prev, node_bytes);
+    h->chain = (int *)grow(h->chain, node_bytes);
+    h->stamp = (uint32_t *)grow(h->stamp, sizeof(uint32_t) * (h->node_capacity + 1));
+    memset(h->stamp, 0, sizeof(uint32_t) * (h->node_capacity + 1));
+    h->generation = 0;
+
+    // one bfs inside the tile from every node gives its edges to the rest of the tile
+    h->num_edges = 0;
+    for (int tile = 0; tile < (int)num_tiles; tile++) {
+        for (int n = h->tile_first[tile]; n < h->tile_first[tile + 1]; n++) {
+            int cell = h->node_cell[n];
+            int row = cell / m->cols, col = cell % m->cols;
+            h->edge_start[n] = (int)h->num_edges;
+            tile_bfs(h, m, cell);
+            for (int other = h->tile_first[tile]; other < h->tile_first[tile + 1]; other++) {
+                int other_cell = h->node_cell[other];
+                int dist = h->local_dist[local_index(other_cell / m->cols, other_cell % m->cols)];
+                if (other != n && dist >= 0) add_edge(h, other, dist);
+            }
+            for (int dir = 0; dir < 4; dir++) {
+                if (!crosses(m, row, col, dir)) continue;
+                int next = (row + d_row[dir]) * m->cols + col + d_col[dir];
+                add_edge(h, find_node(h, next, m->cols), 1);
+            }
+        }
+    }
+    h->edge_start[h->num_nodes] = (int)h->num_edges;
+
+    h->bits = m->bits;
+    h->rows = m->rows;
+    h->cols = m->cols;
+}
+
+static void heap_push(HpaIndex *h, size_t *size, int key, int node) {
+    if (*size == h->heap_capacity) {
+        h->heap_capacity = h->heap_capacity ? h->heap_capacity * 2 : 1024;
+        h->heap = (HeapEntry *)grow(h->heap, sizeof(HeapEntry) * h->heap_capacity);
+    }
+    size_t i = (*size)++;
+    while (i > 0 && h->heap[(i - 1) / 2].dist > key) {
+        h->heap[i] = h->heap[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    h->heap[i] = (HeapEntry){key, node};
+}
+
+static HeapEntry heap_pop(HpaIndex *h, size_t *size) {
+    HeapEntry top = h->heap[0];
+    HeapEntry last = h->heap[--(*size)];
+    size_t i = 0;
+    for (;;) {
+        size_t child = 2 * i + 1;
+        if (child >= *size) break;
+        if (child + 1 < *size && h->heap[child + 1].dist < h->heap[child].dist) child++;
+        if (h->heap[child].dist >= last.dist) break;
+        h->heap[i] = h->heap[child];
+        i = child;
+    }
+    if (*size > 0) h->heap[i] = last;
+    return top;
+}
+
+static inline int manhattan(int a, int b, int cols) {
+    return abs(a / cols - b / cols) + abs(a % cols - b % cols);
+}
+
+static void relax(HpaIndex *h, size_t *heap_size, int node, int cost, int prev, int goal, int cols) {
+    if (h->stamp[node] == h->generation && h->cost[node] <= cost) return;
+    h->stamp[node] = h->generation;
+    h->cost[node] = cost;
+    h->prev[node] = prev;
+    heap_push(h, heap_size, cost + manhattan(h->node_cell[node], goal, cols), node);
+}
+
+// cells after from up to and including to, both in the same tile
+static void push_tile_path(HpaIndex *h, const Maze *m, int from, int to, Path *out) {
+    if (from == to) return;
+    tile_bfs(h, m, to);
+    int row = from / m->cols, col = from % m->cols;
+    while (row * m->cols + col != to) {
+        int dir = h->local_up[local_index(row, col)];
+        row += d_row[dir];
+        col += d_col[dir];
+        path_push(out, (CellPos){row, col});
+    }
+}
+
+bool solve_hpa(const Maze *m, CellPos start, CellPos goal, SolverWorkspace *ws, Path *out) {
+    HpaIndex *h = &ws->hpa;
+    if (h->bits != m->bits || h->rows != m->rows || h->cols != m->cols) hpa_index_build(h, m);
+
+    path_clear(out);
+    h->generation++;
+    if (h->generation == 0) {
+        memset(h->stamp, 0, sizeof(uint32_t) * (h->node_capacity + 1));
+        h->generation = 1;
+    }
+
+    int cols = m->cols;
+    int from = start.row * cols + start.col;
+    int to = goal.row * cols + goal.col;
+    int start_tile = tile_of(h, start.row, start.col);
+    int goal_tile = tile_of(h, goal.row, goal.col);
+    int start_first = h->tile_first[start_tile], start_count = h->tile_first[start_tile + 1] - start_first;
+    int goal_first = h->tile_first[goal_tile], goal_count = h->tile_first[goal_tile + 1] - goal_first;
+
+    // hook the goal up to its tile's nodes, and take the path inside the tile if they share one
+    tile_bfs(h, m, to);
+    int best = INT_MAX;
+    int best_node = -1;    // last node before the goal, -1 for straight there inside the tile
+    if (start_tile == goal_tile && h->local_dist[local_index(start.row, start.col)] >= 0) {
+        best = h->local_dist[local_index(start.row, start.col)];
+    }
+    for (int i = 0; i < goal_count; i++) {
+        int cell = h->node_cell[goal_first + i];
+        h->goal_dist[i] = h->local_dist[local_index(cell / cols, cell % cols)];
+    }
+
+    size_t heap_size = 0;
+    tile_bfs(h, m, from);
+    for (int i = 0; i < start_count; i++) {
+        int cell = h->node_cell[start_first + i];
+        int dist = h->local_dist[local_index(cell / cols, cell % cols)];
+        if (dist >= 0) relax(h, &heap_size, start_first + i, dist, -1, to, cols);
+    }
+
+    while (heap_size > 0) {
+        HeapEntry top = heap_pop(h, &heap_size);
+        int node = top.node;
+        if (top.dist != h->cost[node] + manhattan(h->node_cell[node], to, cols)) continue; // stale
+        if (top.dist >= best) break;
+        out->expanded++;
+
+        if (node >= goal_first && node < goal_first + goal_count) {
+            int rest = h->goal_dist[node - goal_first];
+            if (rest >= 0 && h->cost[node] + rest < best) {
+                best = h->cost[node] + rest;
+                best_node = node;
+            }
+        }
+        for (int e = h->edge_start[node]; e < h->edge_start[node + 1]; e++) {
+            relax(h, &heap_size, h->edges[e].to, h->cost[node] + h->edges[e].cost, node, to, cols);
+        }
+    }
+    if (best == INT_MAX) return false;
+
+    // fill the cells in: start to the first node, node to node, last node to the goal
+    path_reserve(out, best + 1);
+    path_push(out, start);
+    if (best_node < 0) {
+        push_tile_path(h, m, from, to, out);
+        return true;
+    }
+    int count = 0;
+    for (int node = best_node; node >= 0; node = h->prev[node]) h->chain[count++] = node;
+    int cell = from;
+    for (int i = count - 1; i >= 0; i--) {
+        int next = h->node_cell[h->chain[i]];
+        if (tile_of(h, cell / cols, cell % cols) == tile_of(h, next / cols, next % cols)) {
+            push_tile_path(h, m, cell, next, out);
+        } else {
+            path_push(out, (CellPos){next / cols, next % cols}); // across into the next tile
+        }
+        cell = next;
+    }
+    push_tile_path(h, m, cell, to, out);
+    return true;
+}
@@ -0,0 +1,345 @@
+#include "solver.h"
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// solving on the junction graph. most cells of a division maze are in corridors (exactly two open
+// sides), so the graph only has a node for every junction and dead end, plus one edge per corridor
+// weighted by its length. building it walks every cell once; after that a solve is dijkstra over the
+// nodes and copying corridor cells into the path. start and goal can be in the middle of a corridor,
+// then they hook up to the nodes at both ends of it
+
+#define UNASSIGNED INT_MIN
+
+void junction_graph_init(JunctionGraph *g) {
+    memset(g, 0, sizeof(*g));
+}
+
+void junction_graph_free(JunctionGraph *g) {
+    free(g->owner);
+    free(g->position);
+    free(g->corridor_cells);
+    free(g->node_cell);
+    free(g->corridors);
+    free(g->edge_start);
+    free(g->edges);
+    free(g->dist);
+    free(g->prev);
+    free(g->stamp);
+    free(g->heap);
+    free(g->chain);
+    junction_graph_init(g);
+}
+
+size_t junction_graph_bytes(const JunctionGraph *g) {
+    size_t bytes = g->cell_capacity * sizeof(int) * 3;
+    bytes += (size_t)g->node_capacity * (sizeof(int) * 5 + sizeof(uint32_t));
+    bytes += (size_t)g->corridor_capacity * (sizeof(Corridor) + sizeof(int) * 2);
+    bytes += g->heap_capacity * sizeof(HeapEntry);
+    return bytes;
+}
+
+static void *grow(void *p, size_t bytes) {
+    p = realloc(p, bytes);
+    if (!p) {
+        fprintf(stderr, "Failed to reallocate memory for junction graph.\n");
+        exit(EXIT_FAILURE);
+    }
+    return p;
+}
+
+static inline int step(const Maze *m, int cell, int dir) {
+    int row = cell / m->cols + d_row[dir];
+    int col = cell % m->cols + d_col[dir];
+    if (row < 0 || row >= m->rows || col < 0 || col >= m->cols) return -1;
+    if (maze_has_wall(m, cell / m->cols, cell % m->cols, dir)) return -1;
+    return row * m->cols + col;
+}
+
+static int open_sides(const Maze *m, int cell) {
+    int count = 0;
+    for (int dir = 0; dir < 4; dir++) {
+        if (step(m, cell, dir) >= 0) count++;
+    }
+    return count;
+}
+
+static int add_node(JunctionGraph *g, int cell) {
+    if (g->num_nodes == g->node_capacity) {
+        g->node_capacity = g->node_capacity ? g->node_capacity * 2 : 1024;
+        g->node_cell = (int *)grow(g->node_cell, sizeof(int) * g->node_capacity);
+    }
+    g->owner[cell] = g->num_nodes;
+    g->node_cell[g->num_nodes] = cell;
+    return g->num_nodes++;
+}
+
+static void add_corridor(JunctionGraph *g, int from, int to, int first, int count) {
+    if (g->num_corridors == g->corridor_capacity) {
+        g->corridor_capacity = g->corridor_capacity ? g->corridor_capacity * 2 : 1024;
+        g->corridors = (Corridor *)grow(g->corridors, sizeof(Corridor) * g->corridor_capacity);
+    }
+    g->corridors[g->num_corridors++] = (Corridor){from, to, first, count};
+}
+
+// follow every corridor leaving node that hasnt been followed from its other end yet
+static void trace_corridors(JunctionGraph *g, const Maze *m, int node, int *num_cells) {
+    int cell = g->node_cell[node];
+    for (int dir = 0; dir < 4; dir++) {
+        int next = step(m, cell, dir);
+        if (next < 0) continue;
+        if (g->owner[next] >= 0) {
+            // two nodes side by side, a corridor with no cells. added once, from the lower id
+            if (g->owner[next] > node) add_corridor(g, node, g->owner[next], *num_cells, 0);
+            continue;
+        }
+        if (g->owner[next] != UNASSIGNED) continue;
+
+        int corridor = g->num_corridors;
+        int first = *num_cells;
+        int came_from = dir;
+        while (g->owner[next] == UNASSIGNED) {
+            g->owner[next] = -(corridor + 1);
+            g->position[next] = *num_cells - first;
+            g->corridor_cells[(*num_cells)++] = next;
+            int back = (came_from + 2) % 4;
+            for (int d = 0; d < 4; d++) {
+                if (d != back && step(m, next, d) >= 0) {
+                    came_from = d;
+                    break;
+                }
+            }
+            next = step(m, next, came_from);
+        }
+        add_corridor(g, node, g->owner[next], first, *num_cells - first);
+    }
+}
+
+void junction_graph_build(JunctionGraph *g, const Maze *m) {
+    size_t num_cells = (size_t)m->rows * m->cols;
+    if (num_cells > g->cell_capacity) {
+        free(g->owner);
+        free(g->position);
+        free(g->corridor_cells);
+        g->cell_capacity = num_cells;
+        g->owner = (int *)malloc(sizeof(int) * num_cells);
+        g->position = (int *)malloc(sizeof(int) * num_cells);
+        g->corridor_cells = (int *)malloc(sizeof(int) * num_cells);
+        if (!g->owner || !g->position || !g->corridor_cells) {
+            fprintf(stderr, "Failed to allocate memory for junction graph.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    g->num_nodes = 0;
+    g->num_corridors = 0;
+
+    for (int cell = 0; cell < (int)num_cells; cell++) {
+        g->owner[cell] = UNASSIGNED;
+        if (open_sides(m, cell) != 2) add_node(g, cell);
+    }
+    int used = 0;
+    for (int node = 0; node < g->num_nodes; node++) trace_corridors(g, m, node, &used);
+    // whatever is left is a loop with no junction on it at all, one of its cells becomes a node
+    for (int cell = 0; cell < (int)num_cells; cell++) {
+        if (g->owner[cell] == UNASSIGNED) trace_corridors(g, m, add_node(g, cell), &used);
+    }
+
+    // corridors per node. ones that loop back to the same node never help, they are only kept so
+    // a start or goal inside them can be found
+    g->edge_start = (int *)grow(g->edge_start, sizeof(int) * (g->num_nodes + 1));
+    g->edges = (int *)grow(g->edges, sizeof(int) * (2 * (size_t)g->num_corridors + 1));
+    memset(g->edge_start, 0, sizeof(int) * (g->num_nodes + 1));
+    for (int c = 0; c < g->num_corridors; c++) {
+        if (g->corridors[c].from == g->corridors[c].to) continue;
+        g->edge_start[g->corridors[c].from + 1]++;
+        g->edge_start[g->corridors[c].to + 1]++;
+    }
+    for (int n = 0; n < g->num_nodes; n++) g->edge_start[n + 1] += g->edge_start[n];
+    int *fill = (int *)grow(NULL, sizeof(int) * (g->num_nodes + 1));
+    memcpy(fill, g->edge_start, sizeof(int) * (g->num_nodes + 1));
+    for (int c = 0; c < g->num_corridors; c++) {
+        if (g->corridors[c].from == g->corridors[c].to) continue;
+        g->edges[fill[g->corridors[c].from]++] = c;
+        g->edges[fill[g->corridors[c].to]++] = c;
+    }
+    free(fill);
+
+    // dijkstra scratch follows the node count, stamps start over with the new graph
+    g->dist = (int *)grow(g->dist, sizeof(int) * g->node_capacity);
+    g->prev = (int *)grow(g->prev, sizeof(int) * g->node_capacity);
+    g->chain = (int *)grow(g->chain, sizeof(int) * g->node_capacity);
+    g->stamp = (uint32_t *)grow(g->stamp, sizeof(uint32_t) * g->node_capacity);
+    memset(g->stamp, 0, sizeof(uint32_t) * g->node_capacity);
+    g->generation = 0;
+
+    g->bits = m->bits;
+    g->rows = m->rows;
+    g->cols = m->cols;
+}
+
+static void heap_push(JunctionGraph *g, size_t *size, int dist, int node) {
+    if (*size == g->heap_capacity) {
+        g->heap_capacity = g->heap_capacity ? g->heap_capacity * 2 : 1024;
+        g->heap = (HeapEntry *)grow(g->heap, sizeof(HeapEntry) * g->heap_capacity);
+    }
+    size_t i = (*size)++;
+    while (i > 0 && g->heap[(i - 1) / 2].dist > dist) {
+        g->heap[i] = g->heap[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    g->heap[i] = (HeapEntry){dist, node};
+}
+
+static HeapEntry heap_pop(JunctionGraph *g, size_t *size) {
+    HeapEntry top = g->heap[0];
+    HeapEntry last = g->heap[--(*size)];
+    size_t i = 0;
+    for (;;) {
+        size_t child = 2 * i + 1;
+        if (child >= *size) break;
+        if (child + 1 < *size && g->heap[child + 1].dist < g->heap[child].dist) child++;
+        if (g->heap[child].dist >= last.dist) break;
+        g->heap[i] = g->heap[child];
+        i = child;
+    }
+    if (*size > 0) g->heap[i] = last;
+    return top;
+}
+
+// where a cell sits in the graph: the nodes at both ends of its corridor and how far each one is.
+// a node is both of its own ends at distance 0
+typedef struct {
+    int corridor;    // -1 for a node
+    int position;
+    int node[2];
+    int dist[2];
+} GraphSpot;
+
+static GraphSpot locate(const JunctionGraph *g, int cell) {
+    GraphSpot s;
+    int owner = g->owner[cell];
+    if (owner >= 0) {
+        s.corridor = -1;
+        s.position = 0;
+        s.node[0] = s.node[1] = owner;
+        s.dist[0] = s.dist[1] = 0;
+    } else {
+        const Corridor *c = &g->corridors[-owner - 1];
+        s.corridor = -owner - 1;
+        s.position = g->position[cell];
+        s.node[0] = c->from;
+        s.dist[0] = s.position + 1;
+        s.node[1] = c->to;
+        s.dist[1] = c->count - s.position;
+    }
+    return s;
+}
+
+static void relax(JunctionGraph *g, size_t *heap_size, int node, int dist, int prev) {
+    if (g->stamp[node] == g->generation && g->dist[node] <= dist) return;
+    g->stamp[node] = g->generation;
+    g->dist[node] = dist;
+    g->prev[node] = prev;
+    heap_push(g, heap_size, dist, node);
+}
+
+static void push_cell(Path *out, const JunctionGraph *g, int cell) {
+    path_push(out, (CellPos){cell / g->cols, cell % g->cols});
+}
+
+// corridor cells from position a to position b, either way round
+static void push_corridor_cells(Path *out, const JunctionGraph *g, const Corridor *c, int a, int b) {
+    int d = a <= b ? 1 : -1;
+    for (int i = a; ; i += d) {
+        push_cell(out, g, g->corridor_cells[c->first + i]);
+        if (i == b) break;
+    }
+}
+
+// start side, the chain of corridors dijkstra took, then the goal side
+static void build_path(const JunctionGraph *g, GraphSpot start, GraphSpot goal, int goal_side, Path *out) {
+    int count = 0;
+    int node = goal.node[goal_side];
+    while (g->prev[node] >= 0) {
+        const Corridor *c = &g->corridors[g->prev[node]];
+        g->chain[count++] = g->prev[node];
+        node = c->from == node ? c->to : c->from;
+    }
+    int start_side = g->prev[node] == -1 ? 0 : 1;
+
+    if (start.corridor >= 0) {
+        const Corridor *c = &g->corridors[start.corridor];
+        if (start_side == 0) push_corridor_cells(out, g, c, start.position, 0);
+        else push_corridor_cells(out, g, c, start.position, c->count - 1);
+    }
+    push_cell(out, g, g->node_cell[node]);
+    for (int i = count - 1; i >= 0; i--) {
+        const Corridor *c = &g->corridors[g->chain[i]];
+        if (c->count > 0) {
+            if (c->from == node) push_corridor_cells(out, g, c, 0, c->count - 1);
+            else push_corridor_cells(out, g, c, c->count - 1, 0);
+        }
+        node = c->from == node ? c->to : c->from;
+        push_cell(out, g, g->node_cell[node]);
+    }
+    if (goal.corridor >= 0) {
+        const Corridor *c = &g->corridors[goal.corridor];
+        if (goal_side == 0) push_corridor_cells(out, g, c, 0, goal.position);
+        else push_corridor_cells(out, g, c, c->count - 1, goal.position);
+    }
+}
+
+bool solve_junction(const Maze *m, CellPos start, CellPos goal, SolverWorkspace *ws, Path *out) {
+    JunctionGraph *g = &ws->junctions;
+    if (g->bits != m->bits || g->rows != m->rows || g->cols != m->cols) junction_graph_build(g, m);
+
+    path_clear(out);
+    g->generation++;
+    if (g->generation == 0) {
+        memset(g->stamp, 0, sizeof(uint32_t) * g->node_capacity);
+        g->generation = 1;
+    }
+
+    GraphSpot from = locate(g, start.row * m->cols + start.col);
+    GraphSpot to = locate(g, goal.row * m->cols + goal.col);
+
+    // best so far and how it gets to the goal: 0 or 1 through that end of the goal's corridor,
+    // 2 straight along the corridor both of them are in
+    int best = INT_MAX;
+    int best_side = -1;
+    if (from.corridor >= 0 && from.corridor == to.corridor) {
+        best = abs(from.position - to.position);
+        best_side = 2;
+    }
+
+    size_t heap_size = 0;
+    relax(g, &heap_size, from.node[0], from.dist[0], -1);
+    relax(g, &heap_size, from.node[1], from.dist[1], -2);
+    while (heap_size > 0) {
+        HeapEntry top = heap_pop(g, &heap_size);
+        if (top.dist != g->dist[top.node]) continue; // beaten since it was pushed
+        if (top.dist >= best) break;
+        out->expanded++;
+
+        for (int side = 0; side < 2; side++) {
+            if (to.node[side] == top.node && top.dist + to.dist[side] < best) {
+                best = top.dist + to.dist[side];
+                best_side = side;
+            }
+        }
+        for (int e = g->edge_start[top.node]; e < g->edge_start[top.node + 1]; e++) {
+            const Corridor *c = &g->corridors[g->edges[e]];
+            int next = c->from == top.node ? c->to : c->from;
+            // a dead end leads nowhere, it only matters when the goal is there
+            bool dead_end = g->edge_start[next + 1] - g->edge_start[next] == 1;
+            if (dead_end && next != to.node[0] && next != to.node[1]) continue;
+            relax(g, &heap_size, next, top.dist + c->count + 1, g->edges[e]);
+        }
+    }
+
+    if (best_side < 0) return false;
+    if (best_side == 2) push_corridor_cells(out, g, &g->corridors[from.corridor], from.position, to.position);
+    else build_path(g, from, to, best_side, out);
+    return true;
+}
@@ -0,0 +1,329 @@
+#include "solver.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// level synchronous bfs spread over ws->num_threads threads. the queue is the same one solve_bfs builds,
+// every level is a slice of it and gets split into one chunk per thread. a level goes in three steps:
+//  1. every thread looks at the neighbours of its chunk and claims the unvisited ones. the claim is an
+//     atomic max over 4 * queue index + direction (inverted so smaller wins) so when two frontier cells
+//     reach the same cell, the one solve_bfs would have dequeued first gets it no matter who is faster
+//  2. every thread walks its chunk again in order, keeps the cells it won in its own next frontier
+//     buffer and marks them visited
+//  3. the buffers are copied back into the queue one after the other in thread order
+// that puts every level in the exact order solve_bfs would have queued it, which gives the same
+// parents, the same path and the same expanded count. small levels aren't worth waking everyone up for,
+// the calling thread does those as a plain bfs while the others wait. in a perfect maze that is every
+// level (the frontier stays in the hundreds), only mazes with loops get levels past the cutoff
+
+#define PARALLEL_BFS_CUTOFF 2048  // frontier cells before a level gets split over threads
+#define MAX_BFS_THREADS 64
+#define PARALLEL_BFS_MAX_CELLS ((size_t)1 << 30)  // claim values keep index * 4 + dir in 32 bits
+
+// pthread_barrier_t isnt there on mac
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    int count, waiting;
+    unsigned long round;
+} Barrier;
+
+typedef struct {
+    int *cells;              // this threads next frontier
+    size_t count, capacity;
+    bool found_goal;
+} ThreadFrontier;
+
+typedef struct ParallelBfs ParallelBfs;
+
+typedef struct {
+    ParallelBfs *bfs;
+    int id;
+} BfsThread;
+
+struct ParallelBfs {
+    const Maze *m;
+    SolverWorkspace *ws;
+    int goal_index;
+    uint64_t tag;            // generation in the high half of every claim
+    int num_threads;
+    size_t begin, end;       // the level being expanded is queue[begin, end)
+    bool stop;
+    Barrier barrier;
+    ThreadFrontier *frontiers;
+};
+
+static void barrier_init(Barrier *b, int count) {
+    pthread_mutex_init(&b->lock, NULL);
+    pthread_cond_init(&b->cond, NULL);
+    b->count = count;
+    b->waiting = 0;
+    b->round = 0;
+}
+
+static void barrier_destroy(Barrier *b) {
+    pthread_mutex_destroy(&b->lock);
+    pthread_cond_destroy(&b->cond);
+}
+
+static void barrier_wait(Barrier *b) {
+    pthread_mutex_lock(&b->lock);
+    unsigned long round = b->round;
+    if (++b->waiting == b->count) {
+        b->waiting = 0;
+        b->round++;
+        pthread_cond_broadcast(&b->cond);
+    } else {
+        while (round == b->round) pthread_cond_wait(&b->cond, &b->lock);
+    }
+    pthread_mutex_unlock(&b->lock);
+}
+
+static inline bool is_visited(const uint64_t *bits, int cell) {
+    return (bits[cell >> 6] >> (cell & 63)) & 1;
+}
+
+// neighbour of cell in direction dir, -1 if a wall or the edge is in the way
+static inline int neighbour(const Maze *m, int cell, int dir) {
+    int row = cell / m->cols;
+    int col = cell % m->cols;
+    int new_row = row + d_row[dir];
+    int new_col = col + d_col[dir];
+    if (new_row < 0 || new_row >= m->rows || new_col < 0 || new_col >= m->cols) return -1;
+    if (maze_has_wall(m, row, col, dir)) return -1;
+    return new_row * m->cols + new_col;
+}
+
+// queue indexes go up to the number of cells so this needs mazes under 2^30 cells (PARALLEL_BFS_MAX_CELLS)
+static inline uint64_t claim_value(const ParallelBfs *bfs, size_t index, int dir) {
+    return bfs->tag | (0xFFFFFFFFu - (uint32_t)(index * 4 + dir));
+}
+
+// queue[lo, hi) of this level, chunk t of n
+static void chunk(const ParallelBfs *bfs, int t, int n, size_t *lo, size_t *hi) {
+    size_t size = bfs->end - bfs->begin;
+    *lo = bfs->begin + size * t / n;
+    *hi = bfs->begin + size * (t + 1) / n;
+}
+
+// step 1
+static void claim_neighbours(ParallelBfs *bfs, size_t lo, size_t hi) {
+    const int *queue = bfs->ws->queue;
+    uint64_t *claim = bfs->ws->claim;
+    for (size_t i = lo; i < hi; i++) {
+        for (int dir = 0; dir < 4; dir++) {
+            int next = neighbour(bfs->m, queue[i], dir);
+            if (next < 0 || is_visited(bfs->ws->visited_bits, next)) continue;
+            uint64_t want = claim_value(bfs, i, dir);
+            uint64_t seen = __atomic_load_n(&claim[next], __ATOMIC_RELAXED);
+            while (seen < want &&
+                   !__atomic_compare_exchange_n(&claim[next], &seen, want, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+            }
+        }
+    }
+}
+
+static void frontier_push(ThreadFrontier *f, int cell) {
+    if (f->count == f->capacity) {
+        f->capacity = f->capacity ? f->capacity * 2 : 1024;
+        f->cells = (int *)realloc(f->cells, sizeof(int) * f->capacity);
+        if (!f->cells) {
+            fprintf(stderr, "Failed to reallocate memory for bfs frontier.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    f->cells[f->count++] = cell;
+}
+
+// step 2
+static void keep_claimed(ParallelBfs *bfs, size_t lo, size_t hi, ThreadFrontier *f) {
+    SolverWorkspace *ws = bfs->ws;
+    f->count = 0;
+    f->found_goal = false;
+    for (size_t i = lo; i < hi; i++) {
+        for (int dir = 0; dir < 4; dir++) {
+            int next = neighbour(bfs->m, ws->queue[i], dir);
+            if (next < 0 || ws->claim[next] != claim_value(bfs, i, dir)) continue;
+            // other threads are marking cells in the same words
+            __atomic_fetch_or(&ws->visited_bits[next >> 6], 1ULL << (next & 63), __ATOMIC_RELAXED);
+            ws->parent[next] = ws->queue[i];
+            frontier_push(f, next);
+            if (next == bfs->goal_index) f->found_goal = true;
+        }
+    }
+}
+
+// step 3, returns where the buffer of thread t starts in the queue
+static size_t frontier_offset(const ParallelBfs *bfs, int t) {
+    size_t offset = bfs->end;
+    for (int i = 0; i < t; i++) offset += bfs->frontiers[i].count;
+    return offset;
+}
+
+static void *bfs_thread_main(void *arg) {
+    BfsThread *thread = (BfsThread *)arg;
+    ParallelBfs *bfs = thread->bfs;
+    ThreadFrontier *f = &bfs->frontiers[thread->id];
+    for (;;) {
+        barrier_wait(&bfs->barrier); // level ready (or stop)
+        if (bfs->stop) break;
+        size_t lo, hi;
+        chunk(bfs, thread->id, bfs->num_threads, &lo, &hi);
+        claim_neighbours(bfs, lo, hi);
+        barrier_wait(&bfs->barrier);
+        keep_claimed(bfs, lo, hi, f);
+        barrier_wait(&bfs->barrier);
+        memcpy(bfs->ws->queue + frontier_offset(bfs, thread->id), f->cells, sizeof(int) * f->count);
+        barrier_wait(&bfs->barrier); // level done
+    }
+    return NULL;
+}
+
+// the calling thread is thread 0, it runs the same steps as the others
+static void run_level_parallel(ParallelBfs *bfs) {
+    ThreadFrontier *f = &bfs->frontiers[0];
+    size_t lo, hi;
+    barrier_wait(&bfs->barrier);
+    chunk(bfs, 0, bfs->num_threads, &lo, &hi);
+    claim_neighbours(bfs, lo, hi);
+    barrier_wait(&bfs->barrier);
+    keep_claimed(bfs, lo, hi, f);
+    barrier_wait(&bfs->barrier);
+    memcpy(bfs->ws->queue + bfs->end, f->cells, sizeof(int) * f->count);
+    barrier_wait(&bfs->barrier);
+}
+
+// a small level is just solve_bfs, first come first served is already the order it wants
+static void run_level_serial(ParallelBfs *bfs) {
+    SolverWorkspace *ws = bfs->ws;
+    ThreadFrontier *f = &bfs->frontiers[0];
+    size_t back = bfs->end;
+    f->found_goal = false;
+    for (size_t i = bfs->begin; i < bfs->end; i++) {
+        for (int dir = 0; dir < 4; dir++) {
+            int next = neighbour(bfs->m, ws->queue[i], dir);
+            if (next < 0 || is_visited(ws->visited_bits, next)) continue;
+            ws->visited_bits[next >> 6] |= 1ULL << (next & 63);
+            ws->parent[next] = ws->queue[i];
+            ws->queue[back++] = next;
+            if (next == bfs->goal_index) f->found_goal = true;
+        }
+    }
+    f->count = back - bfs->end;
+    for (int t = 1; t < bfs->num_threads; t++) {
+        bfs->frontiers[t].count = 0;
+        bfs->frontiers[t].found_goal = false;
+    }
+}
+
+static void reserve_claims(SolverWorkspace *ws, size_t num_cells) {
+    if (num_cells > ws->claim_capacity) {
+        free(ws->claim);
+        ws->claim_capacity = num_cells;
+        ws->claim = (uint64_t *)calloc(num_cells, sizeof(uint64_t));
+        if (!ws->claim) {
+            fprintf(stderr, "Failed to allocate memory for solver workspace.\n");
+            exit(EXIT_FAILURE);
+        }
+    } else if (ws->generation == 1) {
+        // generation wrapped, claims from before could beat new ones
+        memset(ws->claim, 0, sizeof(uint64_t) * ws->claim_capacity);
+    }
+}
+
+bool solve_bfs_parallel(const Maze *m, CellPos start, CellPos goal, SolverWorkspace *ws, Path *out) {
+    int cols = m->cols;
+    size_t num_cells = (size_t)m->rows * cols;
+    ws->parallel_levels = 0;
+    ws->levels = 0;
+    ws->parallel_cells = 0;
+    // too big for the claim values, the plain bfs gives the same path
+    if (num_cells > PARALLEL_BFS_MAX_CELLS) return solve_bfs(m, start, goal, ws, out);
+    workspace_begin(ws, num_cells);           // queue and parents
+    workspace_begin_compact(ws, num_cells);   // visited bits, cleared
+    reserve_claims(ws, num_cells);
+
+    ParallelBfs bfs;
+    bfs.m = m;
+    bfs.ws = ws;
+    bfs.goal_index = goal.row * cols + goal.col;
+    bfs.tag = (uint64_t)ws->generation << 32;
+    bfs.num_threads = ws->num_threads < 1 ? 1 : ws->num_threads > MAX_BFS_THREADS ? MAX_BFS_THREADS : ws->num_threads;
+    bfs.stop = false;
+    bfs.frontiers = (ThreadFrontier *)calloc(bfs.num_threads, sizeof(ThreadFrontier));
+    BfsThread *threads = (BfsThread *)malloc(sizeof(BfsThread) * bfs.num_threads);
+    pthread_t *handles = (pthread_t *)malloc(sizeof(pthread_t) * bfs.num_threads);
+    if (!bfs.frontiers || !threads || !handles) {
+        fprintf(stderr, "Failed to allocate memory for bfs threads.\n");
+        exit(EXIT_FAILURE);
+    }
+
+    barrier_init(&bfs.barrier, bfs.num_threads);
+    for (int i = 1; i < bfs.num_threads; i++) {
+        threads[i] = (BfsThread){&bfs, i};
+        if (pthread_create(&handles[i], NULL, bfs_thread_main, &threads[i]) != 0) {
+            fprintf(stderr, "Failed to start solver thread.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    path_clear(out);
+    int start_index = start.row * cols + start.col;
+    ws->queue[0] = start_index;
+    ws->parent[start_index] = start_index;
+    ws->visited_bits[start_index >> 6] |= 1ULL << (start_index & 63);
+    bfs.begin = 0;
+    bfs.end = 1;
+
+    bool found_goal = (start_index == bfs.goal_index);
+    size_t goal_position = 0;
+    while (!found_goal && bfs.begin < bfs.end) {
+        ws->levels++;
+        if (bfs.num_threads > 1 && bfs.end - bfs.begin >= PARALLEL_BFS_CUTOFF) {
+            ws->parallel_levels++;
+            ws->parallel_cells += (long)(bfs.end - bfs.begin);
+            run_level_parallel(&bfs);
+        } else {
+            run_level_serial(&bfs);
+        }
+
+        size_t next_end = bfs.end;
+        for (int t = 0; t < bfs.num_threads; t++) {
+            const ThreadFrontier *f = &bfs.frontiers[t];
+            if (f->found_goal && !found_goal) {
+                for (size_t i = next_end; i < next_end + f->count; i++) {
+                    if (ws->queue[i] == bfs.goal_index) goal_position = i;
+                }
+                found_goal = true;
+            }
+            next_end += f->count;
+        }
+        bfs.begin = bfs.end;
+        bfs.end = next_end;
+    }
+
+    if (bfs.num_threads > 1) {
+        bfs.stop = true;
+        barrier_wait(&bfs.barrier);
+        for (int i = 1; i < bfs.num_threads; i++) pthread_join(handles[i], NULL);
+    }
+    barrier_destroy(&bfs.barrier);
+    for (int t = 0; t < bfs.num_threads; t++) free(bfs.frontiers[t].cells);
+    free(bfs.frontiers);
+    free(threads);
+    free(handles);
+
+    if (found_goal) {
+        // solve_bfs takes cells off the queue up to and including the goal
+        out->expanded = (long)goal_position + 1;
+        for (int cell = bfs.goal_index; ; cell = ws->parent[cell]) {
+            path_push(out, (CellPos){cell / cols, cell % cols});
+            if (cell == start_index) break;
+        }
+        path_reverse(out);
+    } else {
+        out->expanded = (long)bfs.end;
+    }
+    return found_goal;
+}
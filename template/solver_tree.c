@@ -0,0 +1,240 @@
+#include "solver.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// distances and paths on a perfect maze without searching. recursive division never cuts a loop, so
+// the passages form a spanning tree and there is exactly one path between any two cells: up from the
+// first to their lowest common ancestor and back down to the second. the index is built once per maze,
+// after that a distance is a few array lookups and a path is just walking the parents.
+//
+// the lca uses the preorder form of the euler tour: with a before b in the preorder, the shallowest
+// cell in (tin[a], tin[b]] is the child of the lca on the way to b (or a root if they arent connected).
+// the range minimum splits into whole blocks of 32 (sparse table) and the two partial blocks at the
+// ends, which read a mask of the cells that were the minimum of some suffix so far. that keeps it
+// O(1) per query and about 20 bytes per cell, a sparse table over every cell would be ~90
+
+#define BLOCK 32
+
+void tree_index_init(TreeIndex *t) {
+    memset(t, 0, sizeof(*t));
+}
+
+void tree_index_free(TreeIndex *t) {
+    free(t->depth);
+    free(t->tin);
+    free(t->order);
+    free(t->up);
+    free(t->block_mask);
+    free(t->table);
+    tree_index_init(t);
+}
+
+size_t tree_index_bytes(const TreeIndex *t) {
+    return t->cell_capacity * (sizeof(int) * 3 + sizeof(uint8_t) + sizeof(uint32_t)) +
+           t->table_capacity * sizeof(int);
+}
+
+static inline int parent_of(const TreeIndex *t, int cell) {
+    int dir = t->up[cell];
+    return (cell / t->cols + d_row[dir]) * t->cols + cell % t->cols + d_col[dir];
+}
+
+// preorder position of the shallower of two positions
+static inline int shallower(const TreeIndex *t, int i, int j) {
+    return t->depth[t->order[j]] < t->depth[t->order[i]] ? j : i;
+}
+
+// shallowest position in [l, r], both in the same block
+static inline int block_min(const TreeIndex *t, int l, int r) {
+    uint32_t mask = t->block_mask[r] & (~0u << (l % BLOCK));
+    return r - r % BLOCK + __builtin_ctz(mask);
+}
+
+// shallowest position in [l, r]
+static int range_min(const TreeIndex *t, int l, int r) {
+    int first = l / BLOCK, last = r / BLOCK;
+    if (first == last) return block_min(t, l, r);
+    int best = shallower(t, block_min(t, l, first * BLOCK + BLOCK - 1), block_min(t, last * BLOCK, r));
+    if (last - first > 1) {
+        int count = last - first - 1;
+        int level = 31 - __builtin_clz((unsigned)count);
+        const int *row = t->table + (size_t)level * t->num_blocks;
+        best = shallower(t, best, row[first + 1]);
+        best = shallower(t, best, row[last - (1 << level)]);
+    }
+    return best;
+}
+
+// lowest common ancestor, -1 when they are in different parts of the maze
+static int lca(const TreeIndex *t, int a, int b) {
+    if (a == b) return a;
+    int ta = t->tin[a], tb = t->tin[b];
+    if (ta > tb) {
+        int temp = ta;
+        ta = tb;
+        tb = temp;
+    }
+    int child = t->order[range_min(t, ta + 1, tb)];
+    return t->up[child] == TREE_ROOT ? -1 : parent_of(t, child);
+}
+
+// preorder dfs over every part of the maze. returns false as soon as it finds a loop
+static bool walk_tree(TreeIndex *t, const Maze *m) {
+    int rows = m->rows, cols = m->cols;
+    int num_cells = rows * cols;
+    uint32_t *stack = t->block_mask; // the masks are only filled in once the dfs is done
+    int count = 0;
+
+    memset(t->up, TREE_UNSEEN, num_cells);
+    for (int root = 0; root < num_cells; root++) {
+        if (t->up[root] != TREE_UNSEEN) continue;
+        t->up[root] = TREE_ROOT;
+        t->depth[root] = 0;
+        int top = 0;
+        stack[top++] = (uint32_t)root;
+
+        while (top > 0) {
+            int current = (int)stack[--top];
+            t->tin[current] = count;
+            t->order[count++] = current;
+            int row = current / cols;
+            int col = current % cols;
+            for (int dir = 0; dir < 4; dir++) {
+                int new_row = row + d_row[dir];
+                int new_col = col + d_col[dir];
+                if (new_row < 0 || new_row >= rows || new_col < 0 || new_col >= cols) continue;
+                if (maze_has_wall(m, row, col, dir)) continue;
+
+                int next = new_row * cols + new_col;
+                if (t->up[next] == TREE_UNSEEN) {
+                    t->up[next] = (uint8_t)((dir + 2) % 4);
+                    t->depth[next] = t->depth[current] + 1;
+                    stack[top++] = (uint32_t)next;
+                } else if (t->up[current] != dir) {
+                    // already reached some other way, there is a loop through here
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+bool tree_index_build(TreeIndex *t, const Maze *m) {
+    size_t num_cells = (size_t)m->rows * m->cols;
+    if (num_cells > t->cell_capacity) {
+        free(t->depth);
+        free(t->tin);
+        free(t->order);
+        free(t->up);
+        free(t->block_mask);
+        t->cell_capacity = num_cells;
+        t->depth = (int *)malloc(sizeof(int) * num_cells);
+        t->tin = (int *)malloc(sizeof(int) * num_cells);
+        t->order = (int *)malloc(sizeof(int) * num_cells);
+        t->up = (uint8_t *)malloc(num_cells);
+        t->block_mask = (uint32_t *)malloc(sizeof(uint32_t) * num_cells);
+        if (!t->depth || !t->tin || !t->order || !t->up || !t->block_mask) {
+            fprintf(stderr, "Failed to allocate memory for tree index.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    t->bits = m->bits;
+    t->rows = m->rows;
+    t->cols = m->cols;
+    t->is_tree = walk_tree(t, m);
+    if (!t->is_tree) return false;
+
+    // in every block, the cells that are still the shallowest of everything after them
+    int n = (int)num_cells;
+    for (int start = 0; start < n; start += BLOCK) {
+        uint32_t stack = 0;
+        for (int i = start; i < n && i < start + BLOCK; i++) {
+            int depth = t->depth[t->order[i]];
+            while (stack) {
+                int top = start + 31 - __builtin_clz(stack);
+                if (t->depth[t->order[top]] < depth) break;
+                stack &= ~(1u << (top - start));
+            }
+            stack |= 1u << (i - start);
+            t->block_mask[i] = stack;
+        }
+    }
+
+    // sparse table over the blocks, level k covers 2^k blocks
+    int blocks = (n + BLOCK - 1) / BLOCK;
+    int levels = 32 - __builtin_clz((unsigned)blocks);
+    size_t table_size = (size_t)levels * blocks;
+    if (table_size > t->table_capacity) {
+        free(t->table);
+        t->table_capacity = table_size;
+        t->table = (int *)malloc(sizeof(int) * table_size);
+        if (!t->table) {
+            fprintf(stderr, "Failed to allocate memory for tree index.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    t->num_blocks = blocks;
+    for (int b = 0; b < blocks; b++) {
+        int last = b * BLOCK + BLOCK - 1;
+        t->table[b] = block_min(t, b * BLOCK, last < n ? last : n - 1);
+    }
+    for (int level = 1; level < levels; level++) {
+        int *row = t->table + (size_t)level * blocks;
+        const int *below = row - blocks;
+        int half = 1 << (level - 1);
+        for (int b = 0; b + 2 * half <= blocks; b++) {
+            row[b] = shallower(t, below[b], below[b + half]);
+        }
+    }
+    return true;
+}
+
+// true when the index had to be (re)built for this maze
+static bool ensure_index(TreeIndex *t, const Maze *m) {
+    if (t->bits == m->bits && t->rows == m->rows && t->cols == m->cols) return false;
+    tree_index_build(t, m);
+    return true;
+}
+
+int tree_distance(const Maze *m, CellPos a, CellPos b, SolverWorkspace *ws) {
+    TreeIndex *t = &ws->tree;
+    ensure_index(t, m);
+    if (!t->is_tree) return flood_distance(m, a, b, ws);
+
+    int from = a.row * m->cols + a.col;
+    int to = b.row * m->cols + b.col;
+    int common = lca(t, from, to);
+    if (common < 0) return -1;
+    return t->depth[from] + t->depth[to] - 2 * t->depth[common];
+}
+
+bool solve_tree(const Maze *m, CellPos start, CellPos goal, SolverWorkspace *ws, Path *out) {
+    TreeIndex *t = &ws->tree;
+    bool built = ensure_index(t, m);
+    if (!t->is_tree) return solve_bfs(m, start, goal, ws, out);
+
+    path_clear(out);
+    // the build visits every cell, a query on a built index visits none
+    if (built) out->expanded = (long)m->rows * m->cols;
+    int from = start.row * m->cols + start.col;
+    int to = goal.row * m->cols + goal.col;
+    int common = lca(t, from, to);
+    if (common < 0) return false;
+
+    // the start side fills in from the front and the goal side from the back, meeting at the lca
+    int length = t->depth[from] + t->depth[to] - 2 * t->depth[common] + 1;
+    path_reserve(out, length);
+    out->length = length;
+    int i = 0;
+    for (int cell = from; cell != common; cell = parent_of(t, cell)) {
+        out->cells[i++] = (CellPos){cell / m->cols, cell % m->cols};
+    }
+    out->cells[i] = (CellPos){common / m->cols, common % m->cols};
+    i = length - 1;
+    for (int cell = to; cell != common; cell = parent_of(t, cell)) {
+        out->cells[i--] = (CellPos){cell / m->cols, cell % m->cols};
+    }
+    return true;
+}
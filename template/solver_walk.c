@@ -0,0 +1,133 @@
+#include "solver.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// the left hand rule played out without animating it. the interactive solver used to decide one move per
+// animation and could walk in circles forever; this runs the whole walk at once (millions of steps a second)
+// and hands back the list of moves for the player to replay. a state is the cell plus the way the walker
+// faces when it decides, and because that is all the next decision depends on, seeing a state again means
+// the walk will only ever repeat itself from there
+
+void wall_walk_init(WallWalk *w) {
+    memset(w, 0, sizeof(*w));
+}
+
+void wall_walk_free(WallWalk *w) {
+    free(w->moves);
+    free(w->seen);
+    wall_walk_init(w);
+}
+
+size_t wall_walk_bytes(const WallWalk *w) {
+    return w->move_capacity + w->seen_words * sizeof(uint64_t);
+}
+
+static void push_move(WallWalk *w, WalkMove move) {
+    if ((size_t)w->num_moves == w->move_capacity) {
+        w->move_capacity = w->move_capacity ? w->move_capacity * 2 : 1024;
+        w->moves = (uint8_t *)realloc(w->moves, w->move_capacity);
+        if (!w->moves) {
+            fprintf(stderr, "Failed to reallocate memory for wall walk.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    w->moves[w->num_moves++] = (uint8_t)move;
+}
+
+// one decision: always left first, then straight, then right, then turn around. returns the direction to
+// step in, or -1 for a dead end where the walker turned around and decides again in the same cell.
+// the turns go into w when it isnt NULL
+static int decide(const Maze *m, int row, int col, int direction, WallWalk *w) {
+    int left_direction = (direction + 3) % 4;
+    int right_direction = (direction + 1) % 4;
+    if (!maze_has_wall(m, row, col, left_direction)) {
+        if (w) push_move(w, WALK_TURN_LEFT);
+        return left_direction;
+    }
+    if (!maze_has_wall(m, row, col, direction)) return direction;
+    if (!maze_has_wall(m, row, col, right_direction)) {
+        if (w) push_move(w, WALK_TURN_RIGHT);
+        return right_direction;
+    }
+    if (w) {
+        push_move(w, WALK_TURN_RIGHT);
+        push_move(w, WALK_TURN_RIGHT);
+    }
+    return -1;
+}
+
+// forward moves it takes to come back to (row, col, direction), which is known to be on a loop
+static long loop_length(const Maze *m, int row, int col, int direction) {
+    int start_row = row, start_col = col, start_direction = direction;
+    long steps = 0;
+    do {
+        int dir = decide(m, row, col, direction, NULL);
+        if (dir < 0) {
+            direction = (direction + 2) % 4;
+            continue;
+        }
+        direction = dir;
+        row += d_row[dir];
+        col += d_col[dir];
+        steps++;
+    } while (row != start_row || col != start_col || direction != start_direction);
+    return steps;
+}
+
+WalkResult walk_left_hand(const Maze *m, CellPos start, int direction, CellPos goal, WallWalk *w) {
+    size_t words = ((size_t)m->rows * m->cols * 4 + 63) / 64;
+    if (words > w->seen_words) {
+        free(w->seen);
+        w->seen_words = words;
+        w->seen = (uint64_t *)malloc(sizeof(uint64_t) * words);
+        if (!w->seen) {
+            fprintf(stderr, "Failed to allocate memory for wall walk.\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+    memset(w->seen, 0, sizeof(uint64_t) * words);
+    w->num_moves = 0;
+    w->steps = 0;
+    w->loop_steps = 0;
+
+    int row = start.row, col = start.col;
+    WalkResult result;
+    for (;;) {
+        if (row == goal.row && col == goal.col) {
+            result = WALK_REACHED_GOAL;
+            break;
+        }
+        size_t state = ((size_t)row * m->cols + col) * 4 + direction;
+        if (w->seen[state / 64] >> (state % 64) & 1) {
+            result = WALK_LOOPED;
+            w->loop_steps = loop_length(m, row, col, direction);
+            break;
+        }
+        w->seen[state / 64] |= 1ull << (state % 64);
+
+        int dir = decide(m, row, col, direction, w);
+        if (dir < 0) {
+            direction = (direction + 2) % 4;
+            continue;
+        }
+        direction = dir;
+        int new_row = row + d_row[dir];
+        int new_col = col + d_col[dir];
+        if (new_row < 0 || new_row >= m->rows || new_col < 0 || new_col >= m->cols) {
+            // facing out of the entrance, the exit wasnt reachable this way
+            result = WALK_LEFT_MAZE;
+            break;
+        }
+        push_move(w, WALK_FORWARD);
+        w->steps++;
+        row = new_row;
+        col = new_col;
+    }
+
+    w->result = result;
+    w->turns = w->num_moves - w->steps;
+    w->end = (CellPos){row, col};
+    w->end_direction = direction;
+    return result;
+}
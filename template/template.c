@@ -5,30 +5,48 @@
 #include <math.h>
 #include <string.h>
 #include <stdbool.h>
+#include <pthread.h>
 #include <OpenGL/OpenGL.h>
 #include <GLUT/glut.h>
 #include "initShader.h"
 #include "tempLib.h"
+#include "maze.h"
+#include "maze_export.h"
+#include "maze_file.h"
+#include "mesh.h"
+#include "solver.h"
+#include "timing.h"
+#include "headless.h"
+#include "move_queue.h"
 
 //prototypes
 vec4 map_coords(int x, int y);  
 void create_rotation();
-void init_block();
 void init_grassblock();
-void init_texture(float x, float y);
-void generate_pyramid(int x_size, int z_size);
+void generate_pyramid(int x_size, int z_size, Rng *rng);
 void display_sun();
+void build_scene();
+void upload_scene();
+void upload_vertices(int first, int count);
 void forward();
+void forward_run(int cells);
 void backward();
 void slide_left();
 void slide_right();
 void turn_left();
 void turn_right();
 bool can_move_inside_maze(int row, int col, int direction);
+void set_platform_size();
 bool can_reenter_maze(int exit_direction, int current_direction, char movement_type);
 void print_location(void);
 void shortest_path(int player_row, int player_col, int direction, bool inside_maze);
-void solve_maze_lh();
+void start_left_hand();
+void feed_left_hand();
+void feed_route();
+void start_solve();
+bool solver_idle();
+bool moves_locked();
+void toggle_wall_ahead();
 
 // mouse, rotation, and scaling variables
 float scale_factor = 1.0f; 
@@ -44,6 +62,7 @@ mat4 rotation_matrix = {{1,0,0,0},{0,1,0,0},{0,0,1,0},{0,0,0,1}};
 mat4 prev_ctm = {{1,0,0,0},{0,1,0,0},{0,0,1,0},{0,0,0,1}};
 mat4 ctm = {{1,0,0,0},{0,1,0,0},{0,0,1,0},{0,0,0,1}};
 GLuint ctm_location;
+GLuint program;
 
 float lrbt = .75;
 float near = -.75;
@@ -64,21 +83,14 @@ vec4 at;
 vec4 up = {0, 1, 0, 0};
 GLuint user_position_location;
 
-//cube and platform global variables
-float scale_cube = 1.00f;
-int num_vertices_per_block = 36; 
+//cube and platform global variables (the shared vertex arrays live in mesh.c)
 int num_blocks = 0; 
-int num_vertices = 0;
 int x_size;
 int z_size; 
 int maze_x_size = 0;
 int maze_z_size = 0;
 
 //array global variable
-vec4 *positions = NULL;
-vec2 *tex_coords = NULL;
-vec4 *block_positions = NULL; // Store positions for a single block
-vec2 *block_tex_coords = NULL; 
 vec4 *normals = NULL;
 
 //sun global varibles
@@ -101,8 +113,10 @@ int direction = 0; // 0 = North, 1 = East, 2 = South, 3 = West
 int exit_direction = -1; // -1 for no direction, but otherwise follows same rules as avove
 bool inside_maze = false; // is the player inside the maze? 
 
-//left hand rule
+//left hand rule, the whole walk is worked out when 'k' is pressed and fed to the movement queue as it empties
 int maze_solving_in_progress = 0;
+WallWalk lh_walk;
+long lh_next = 0; // next move of lh_walk to queue
 
 //lighting stuff
 GLuint enable_light_location;
@@ -124,6 +138,7 @@ vec4 look_direction;
 int is_animating = 0; // Animation state
 int num_steps = 0; // Current step
 int max_steps = 40; // Max number of steps for animation
+int forward_steps = 40; // steps for the current forward move, a run of cells gets a few more
 int reset_animation = 0;
 int forward_animation = 0;
 int backward_animation = 0;
@@ -140,25 +155,25 @@ float new_at_x, new_at_z;
 vec4 temp_eye;
 vec4 temp_at;
 
-// gonna make the maze using a 2d array of structs
-typedef struct {
-    bool top_wall;    // true if the wall exists
-    bool bottom_wall;
-    bool left_wall;  
-    bool right_wall; 
-} Cell;
+// the maze walls, see maze.h for the layout
+Maze maze;
 
-Cell **maze;
+// solver buffers, kept for the whole run so pressing the solve key again doesnt reallocate.
+// path_solver is what 'z' runs, --solver picks it
+SolverWorkspace solver_ws;
+Path solver_path;
 
-//this and the node are for shortest path
-// direction offsets: (North, East, South, West) used to calculate position in next cell during BFS
-int d_row[] = {-1, 0, 1, 0};
-int d_col[] = {0, 1, 0, -1};
+// the route 'z' is walking, handed to the movement queue a run at a time as it empties. route_ready is set
+// by the solve thread and picked up when it is joined
+RouteCursor route;
+int route_direction; // which way the player faces when the next run starts
+bool route_ready = false;
+int route_in_progress = 0;
+const SolverInfo *path_solver;
 
-typedef struct {
-    int row, col;  // current position
-    int parent_row, parent_col;  // parent position for path reconstruction
-} Node;
+// random state for the maze and the scenery around it, seeded from --seed or the clock
+uint64_t seed;
+Rng rng;
 
 //a queue to hold movements to animate in order
 typedef enum {
@@ -170,37 +185,43 @@ typedef enum {
     TURN_RIGHT
 } MovementType;
 
-typedef struct {
-    MovementType type;
-} MovementCommand;
-
-#define QUEUE_SIZE 100
-MovementCommand movement_queue[QUEUE_SIZE];
-int queue_front = 0, queue_back = 0;
+//it grows as needed, so a route through a big maze never loses moves. the 'z' solve thread pushes into it
+//while the main loop pops, anything else only pushes while that thread isnt running
+MoveQueue movement_queue;
 
-//function to put the movements into the queue
+//function to put the movements into the queue. a queued move is the type in the low byte and how many
+//cells it covers above that, only MOVE_FORWARD uses more than one
 void enqueue_movement(MovementType type) {
-    if ((queue_back + 1) % QUEUE_SIZE == queue_front) {
-        fprintf(stderr, "Movement queue overflow!\n");
-        return;
-    }
-    movement_queue[queue_back].type = type;
-    queue_back = (queue_back + 1) % QUEUE_SIZE;
+    move_queue_push(&movement_queue, type | 1u << 8);
+}
+
+//turn from facing one direction to another the short way round
+void enqueue_turn(int from, int to) {
+    int turns = shortest_turn(from, to);
+    if (turns < 0) enqueue_movement(TURN_LEFT);
+    for (int i = 0; i < turns; i++) enqueue_movement(TURN_RIGHT);
+}
+
+//the left hand rule and 'z' routes top the queue up to this many moves as it empties instead of queueing
+//everything at once, which would only hold memory for moves that are minutes away
+#define QUEUE_AHEAD 256
+
+//a straight run of cells, played as one move
+void enqueue_forward(int cells) {
+    move_queue_push(&movement_queue, MOVE_FORWARD | (uint32_t)cells << 8);
 }
 
 //and a function to dequeue and execute the next movement
 void process_next_movement() {
-    if (queue_front == queue_back) {
+    uint32_t move;
+    if (!move_queue_pop(&movement_queue, &move)) {
         // No more movements in the queue
         return;
     }
 
-    MovementCommand cmd = movement_queue[queue_front];
-    queue_front = (queue_front + 1) % QUEUE_SIZE;
-
     // Execute the movement
-    switch (cmd.type) {
-        case MOVE_FORWARD: forward(); break;
+    switch ((MovementType)(move & 0xff)) {
+        case MOVE_FORWARD: forward_run((int)(move >> 8)); break;
         case MOVE_BACKWARD: backward(); break;
         case SLIDE_LEFT: slide_left(); break;
         case SLIDE_RIGHT: slide_right(); break;
@@ -209,442 +230,138 @@ void process_next_movement() {
     }
 }
 
-//allocate mem for maze size
-void allocate_maze(int rows, int cols) {
-    maze = (Cell **)malloc(rows * sizeof(Cell *));
-    if (!maze) {
-        fprintf(stderr, "Failed to allocate memory for maze rows.\n");
-        exit(EXIT_FAILURE);
-    }
-
-    for (int i = 0; i < rows; i++) {
-        maze[i] = (Cell *)malloc(cols * sizeof(Cell));
-        if (!maze[i]) {
-            fprintf(stderr, "Failed to allocate memory for maze columns.\n");
-            exit(EXIT_FAILURE);
-        }
-    }
-}
-
-//cleanup the rows and then the pointers for each row (teardown)
-void free_maze(int rows) {
-    if (maze) {
-        for (int i = 0; i < rows; i++) {
-            if (maze[i]) free(maze[i]);
-        }
-        free(maze);
-        maze = NULL;
-    }
+//the 'z' solve runs on its own thread so a big maze doesnt freeze the window. it queues the steps into the
+//maze straight away and leaves a cursor over the route in route, which idle() feeds to the queue once the
+//thread is joined. solve_state is 0 when idle, 1 while it runs and 2 once it is done and waiting to be joined
+typedef struct {
+    int row, col, direction;
+    bool inside;
+} SolveJob;
+pthread_t solve_thread;
+SolveJob solve_job;
+int solve_state = 0;
+
+void *solve_thread_main(void *arg) {
+    SolveJob *job = (SolveJob *)arg;
+    shortest_path(job->row, job->col, job->direction, job->inside);
+    __atomic_store_n(&solve_state, 2, __ATOMIC_RELEASE);
+    return NULL;
 }
 
-// create the maze with bording walls + the entrance and exit and all the walls inside should be disabled for now
-void init_maze(int rows, int cols) {
-    for (int i = 0; i < rows; i++) {
-        for (int j = 0; j < cols; j++) {
-            // set border walls
-            maze[i][j].top_wall = (i == 0);              
-            maze[i][j].bottom_wall = (i == rows - 1);    
-            maze[i][j].left_wall = (j == 0);             
-            maze[i][j].right_wall = (j == cols - 1);      
-        }
+//joins the solve thread if it has finished, returns whether nothing is solving now
+bool solver_idle() {
+    int state = __atomic_load_n(&solve_state, __ATOMIC_ACQUIRE);
+    if (state == 1) return false;
+    if (state == 2) {
+        pthread_join(solve_thread, NULL);
+        solve_state = 0;
+        route_in_progress = route_ready;
     }
-
-    // create entrance (remove bottom left, bottom wall)
-    maze[rows - 1][0].bottom_wall = false;
-
-    // create exit (remove top right, top wall)
-    maze[0][cols - 1].top_wall = false;
+    return true;
 }
 
-// helper function for picking rand values 
-int rand_between(int low, int high) {
-    if (low >= high) {
-        return low; // avoid invalid range
-    }
-    return low + rand() % (high - low);
+//the solve thread works from where the player stood when 'z' was pressed, so the movement keys do nothing
+//until it is done. true (after saying so) while they have to wait
+bool moves_locked() {
+    if (solver_idle()) return false;
+    printf("Still working out the route from here, wait before moving.\n");
+    return true;
 }
 
-//function to randomly generate the maze
-void generate_maze(int row_start, int row_end, int col_start, int col_end) {
-    // if the chamber is too small, stop recursion here
-    if (row_end - row_start < 1 || col_end - col_start < 1) {
+void start_solve() {
+    if (!solver_idle()) {
+        printf("Still working out the last route.\n");
         return;
     }
-
-    // randomly pick a dividing row and column
-    int divide_row = rand_between(row_start + 1, row_end); // ensure its not on a boundary
-    int divide_col = rand_between(col_start + 1, col_end); 
-
-    // add walls vertically and horisontally from that point
-
-    //vert wall
-    for (int r = row_start; r <= row_end; r++) {
-        maze[r][divide_col - 1].right_wall = true; // east wall of left section
-        maze[r][divide_col].left_wall = true;     // west wall of right section
-    }
-
-    //horizontal wall
-    for (int c = col_start; c <= col_end; c++) {
-        maze[divide_row - 1][c].bottom_wall = true; // south wall of top section
-        maze[divide_row][c].top_wall = true;       // north wall of bottom section
-    }
-
-    // next, randomly open one wall in three of the four sections
-    bool opened[4] = {false, false, false, false}; // track which walls have been opened
-    int directions[] = {0, 1, 2, 3};              // directions: 0=N, 1=E, 2=S, 3=W
-    for (int i = 0; i < 3; i++) {
-        int dir_idx = rand_between(0, 4 - i); // pick random direction
-        int dir = directions[dir_idx];
-        directions[dir_idx] = directions[3 - i]; // remove this direction from pool so its not picked again
-
-        // open a wall in the chosen direction
-        if (dir == 0 && !opened[0]) { // north
-            int col = rand_between(col_start, divide_col); //pick seg to open
-            maze[divide_row - 1][col].bottom_wall = false; //remove the wall for the 2 bordering units
-            maze[divide_row][col].top_wall = false; //       ^^
-            opened[0] = true;
-        } else if (dir == 1 && !opened[1]) { // east
-            int row = rand_between(row_start, divide_row);
-            maze[row][divide_col].left_wall = false;
-            maze[row][divide_col - 1].right_wall = false;
-            opened[1] = true;
-        } else if (dir == 2 && !opened[2]) { // south
-            int col = rand_between(divide_col, col_end + 1);
-            maze[divide_row][col].top_wall = false;
-            maze[divide_row - 1][col].bottom_wall = false;
-            opened[2] = true;
-        } else if (dir == 3 && !opened[3]) { // west
-            int row = rand_between(divide_row, row_end + 1);
-            maze[row][divide_col - 1].right_wall = false;
-            maze[row][divide_col].left_wall = false;
-            opened[3] = true;
-        }
-    }
-
-    // recursive call for each chamber made from this division
-    generate_maze(row_start, divide_row - 1, col_start, divide_col - 1); // top left
-    generate_maze(row_start, divide_row - 1, divide_col, col_end);       // top right
-    generate_maze(divide_row, row_end, col_start, divide_col - 1);       // bottom left
-    generate_maze(divide_row, row_end, divide_col, col_end);             // bottom right
-    
-}
-
-// bang. maze time
-void make_maze(int rows, int cols) {
-    allocate_maze(rows, cols);
-    init_maze(rows, cols); 
-    generate_maze(0, rows - 1, 0, cols - 1); 
-}
-
-//function to print a text version of the maze so i know its correct
-void print_maze(int rows, int cols) {
-    for (int i = 0; i < rows; i++) {
-        for (int j = 0; j < cols; j++) {
-            printf("+");
-            printf(maze[i][j].top_wall ? "---" : "   ");
-        }
-        printf("+\n");
-
-        for (int j = 0; j < cols; j++) {
-            printf(maze[i][j].left_wall ? "|" : " "); 
-            printf("   ");
-        }
-
-        if (i == rows - 1 && cols > 0) {
-            printf(maze[rows - 1][cols - 1].right_wall ? "|" : " ");
-        } else {
-            printf("|");
-        }
-        printf("\n");
-    }
-    
-    for (int j = 0; j < cols; j++) {
-        printf("+");
-        printf(maze[rows - 1][j].bottom_wall ? "---" : "   ");
+    maze_solving_in_progress = 0; // the left hand rule stops pushing moves
+    route_in_progress = 0;
+    move_queue_clear(&movement_queue);
+    solve_job = (SolveJob){player_row, player_col, direction, inside_maze};
+    solve_state = 1;
+    if (pthread_create(&solve_thread, NULL, solve_thread_main, &solve_job) != 0) {
+        // no thread, solve here instead
+        solve_state = 0;
+        shortest_path(player_row, player_col, direction, inside_maze);
+        route_in_progress = route_ready;
     }
-    printf("+\n");
 }
 
-//make the maze flooring
-void generate_maze_floor(int maze_x, int maze_z) {
-    //plank texture for floor
-    init_texture(1.0f, 0.75f);
-
-    // calculate floor dimensions
-    int floor_width = maze_x * 5 - (maze_x - 1);  // total blocks in x-axis
-    int floor_depth = maze_z * 5 - (maze_z - 1);  // total blocks in z-axis
+// every vertex in the scene: pyramid, maze and sun, plus the normals. the scenery is drawn from rng, so it is
+// reseeded first and a rebuild after a wall change keeps the same pyramid and poles
+void build_scene() {
+    free_mesh();
+    if (normals) free(normals);
+    num_blocks = 0;
+    rng_seed(&rng, seed, 0);
 
-    // calculate total number of blocks and vertices
-    int floor_blocks = floor_width * floor_depth;
-    int floor_vertices = floor_blocks * num_vertices_per_block;
-
-    // allocate memory for positions and texture coords
-    vec4 *floor_positions = (vec4 *)malloc(sizeof(vec4) * floor_vertices);
-    vec2 *floor_tex_coords = (vec2 *)malloc(sizeof(vec2) * floor_vertices);
-    if (!floor_positions || !floor_tex_coords) {
-        fprintf(stderr, "Failed to allocate memory for maze floor.\n");
-        exit(EXIT_FAILURE);
-    }
+    init_grassblock();
+    generate_pyramid(x_size, z_size, &rng);
+    display_maze(&maze, &rng);
+    display_sun();
 
-    int index = 0;
-    float y_translation = scale_cube * 0.5f;
-    float block_size = scale_cube * 0.5f;
-
-    // calculate offsets to center the floor
-    float x_offset = -(floor_width / 2.0f) * block_size + block_size / 2.0f;
-    float z_offset = -(floor_depth / 2.0f) * block_size + block_size / 2.0f;
-
-    // loop through the maze dimensions and create the floor
-    for (int i = 0; i < floor_depth; ++i) {
-        for (int j = 0; j < floor_width; ++j) {
-            // calculate translation for the current block
-            float x_translation = j * block_size + x_offset;
-            float z_translation = i * block_size + z_offset;
-
-            // then copy block positions and apply translation
-            for (int k = 0; k < num_vertices_per_block; ++k) {
-                floor_positions[index] = block_positions[k];
-                floor_positions[index].x += x_translation;
-                floor_positions[index].y += y_translation;
-                floor_positions[index].z += z_translation;
-                floor_tex_coords[index] = block_tex_coords[k];
-                index++;
+    normals = (vec4 *) malloc(sizeof(vec4) * num_vertices);
+    for(int i = 0; i < num_vertices; i += 36){
+        for(int j = 0; j < 36; j++){
+            if(j <= 5){
+                normals[i + j] = (vec4) {0, 0, 1, 0};
             }
-        }
-    }
-
-    // update global positions and tex_coords with the new floor data
-    num_vertices += floor_vertices;
-    positions = (vec4 *)realloc(positions, sizeof(vec4) * num_vertices);
-    tex_coords = (vec2 *)realloc(tex_coords, sizeof(vec2) * num_vertices);
-
-    if (!positions || !tex_coords) {
-        fprintf(stderr, "Failed to reallocate memory for maze floor vertices.\n");
-        exit(EXIT_FAILURE);
-    }
-
-    memcpy(positions + (num_vertices - floor_vertices), floor_positions, sizeof(vec4) * floor_vertices);
-    memcpy(tex_coords + (num_vertices - floor_vertices), floor_tex_coords, sizeof(vec2) * floor_vertices);
-
-    free(floor_positions);
-    free(floor_tex_coords);
-}
-
-//make the verts or poles
-void generate_maze_poles(int maze_x, int maze_z) {
-    // cracked stone brick for poles
-    init_texture(0.5f, 0.5f);
-
-    // calculate amount of poles
-    int num_poles_x = maze_x + 1;
-    int num_poles_z = maze_z + 1;
-
-    // pole block size and base height
-    float block_size = scale_cube * 0.5f;
-    float base_height = scale_cube;
-
-    // calculate offsets to center the poles
-    float x_offset = -(maze_x * 5 - (maze_x - 1)) / 2.0f * block_size + block_size / 2.0f;
-    float z_offset = -(maze_z * 5 - (maze_z - 1)) / 2.0f * block_size + block_size / 2.0f;
-
-    // temporary lists to store pole vertices and texture coordinates
-    int max_pole_blocks = num_poles_x * num_poles_z * 5;  // max of 5 blocks per pole
-    int max_pole_vertices = max_pole_blocks * num_vertices_per_block;
-
-    vec4 *temp_positions = (vec4 *)malloc(sizeof(vec4) * max_pole_vertices);
-    vec2 *temp_tex_coords = (vec2 *)malloc(sizeof(vec2) * max_pole_vertices);
-
-    if (!temp_positions || !temp_tex_coords) {
-        fprintf(stderr, "Failed to allocate memory for maze poles.\n");
-        exit(EXIT_FAILURE);
-    }
-
-    int index = 0;
-
-    // loop through poles along the grid
-    for (int i = 0; i < num_poles_z; ++i) {
-        for (int j = 0; j < num_poles_x; ++j) {
-            // find base position of pole
-            float x_pole = j * (5 * block_size - block_size) + x_offset;
-            float z_pole = i * (5 * block_size - block_size) + z_offset;
-
-            // randomize pole height between 3 and 5 blocks
-            int pole_height = rand_between(3, 6);  // 6 is exclusive here
-
-            // stack blocks vertically to build the pole
-            for (int h = 0; h < pole_height; ++h) {
-                // add a block at the current height
-                for (int k = 0; k < num_vertices_per_block; ++k) {
-                    temp_positions[index] = block_positions[k];
-                    temp_positions[index].x += x_pole;
-                    temp_positions[index].y += base_height + h * block_size;
-                    temp_positions[index].z += z_pole;
-
-                    temp_tex_coords[index] = block_tex_coords[k];
-                    index++;
-                }
+            else if(j > 5 && j <= 11){
+                normals[i + j] = (vec4) {1, 0, 0, 0};
             }
-        }
-    }
-
-    // update global positions and tex_coords with the new pole data
-    int pole_vertices = index;  // total vertices used for poles
-
-    positions = (vec4 *)realloc(positions, sizeof(vec4) * (num_vertices + pole_vertices));
-    tex_coords = (vec2 *)realloc(tex_coords, sizeof(vec2) * (num_vertices + pole_vertices));
-
-    if (!positions || !tex_coords) {
-        fprintf(stderr, "Failed to reallocate memory for maze pole vertices.\n");
-        exit(EXIT_FAILURE);
-    }
-
-    memcpy(positions + num_vertices, temp_positions, sizeof(vec4) * pole_vertices);
-    memcpy(tex_coords + num_vertices, temp_tex_coords, sizeof(vec2) * pole_vertices);
-
-    num_vertices += pole_vertices;  // update the total vertex count
-
-    free(temp_positions);
-    free(temp_tex_coords);
-}
-
-//make the walls according to the random maze generation
-void generate_maze_walls(int maze_x, int maze_z) {
-    // brick texture
-    init_texture(1.0f, 0.50f);
-
-    // block size and base height
-    float block_size = scale_cube * 0.5f;
-    float base_height = scale_cube;
-
-    //adjust offsets to center the walls
-    float x_offset = -((maze_x * 5 - (maze_x - 1)) / 2.0f) * block_size + 2.5 * block_size;
-    float z_offset = -((maze_z * 5 - (maze_z - 1)) / 2.0f) * block_size + 2.5 * block_size;
-
-
-    // temp arrays for wall vertices and text coords
-    int max_wall_blocks = (maze_x * maze_z * 4) * 15;  // walls are made of 3 segments. segments have max height of 5
-    int max_wall_vertices = max_wall_blocks * num_vertices_per_block;
-
-    vec4 *temp_positions = (vec4 *)malloc(sizeof(vec4) * max_wall_vertices);
-    vec2 *temp_tex_coords = (vec2 *)malloc(sizeof(vec2) * max_wall_vertices);
-
-    if (!temp_positions || !temp_tex_coords) {
-        fprintf(stderr, "Failed to allocate memory for maze walls.\n");
-        exit(EXIT_FAILURE);
-    }
-
-    int index = 0;
-
-    // loop through maze grid
-    for (int i = 0; i < maze_z; ++i) {
-        for (int j = 0; j < maze_x; ++j) {
-            // find base position of current cell
-            float x_cell = j * (5 * block_size - block_size) + x_offset;
-            float z_cell = i * (5 * block_size - block_size) + z_offset;
-
-            // add walls based on maze structure
-            if (maze[i][j].top_wall) {
-                for (int segment = 0; segment < 3; ++segment) { //3 segments per wall
-                    int wall_height = rand_between(3, 6); // need random height for each segment
-                    for (int h = 0; h < wall_height; ++h) {
-                        for (int k = 0; k < num_vertices_per_block; ++k) {
-                            temp_positions[index] = block_positions[k];
-                            temp_positions[index].x += x_cell + (segment - 1) * block_size;  // offset for segment
-                            temp_positions[index].y += base_height + h * block_size;
-                            temp_positions[index].z += z_cell - 2.0f * block_size;  // corrected offset for top wall
-                            temp_tex_coords[index] = block_tex_coords[k];
-                            index++;
-                        }
-                    }
-                }
+            else if(j > 11 && j <= 17){
+                normals[i + j] = (vec4) {-1, 0, 0, 0};
             }
-
-            if (maze[i][j].bottom_wall) {
-                for (int segment = 0; segment < 3; ++segment) {
-                    int wall_height = rand_between(3, 6);
-                    for (int h = 0; h < wall_height; ++h) {
-                        for (int k = 0; k < num_vertices_per_block; ++k) {
-                            temp_positions[index] = block_positions[k];
-                            temp_positions[index].x += x_cell + (segment - 1) * block_size;
-                            temp_positions[index].y += base_height + h * block_size;
-                            temp_positions[index].z += z_cell + 2.0f * block_size;  // corrected offset for bottom wall
-                            temp_tex_coords[index] = block_tex_coords[k];
-                            index++;
-                        }
-                    }
-                }
+            else if(j > 17 && j <= 23){
+                normals[i + j] = (vec4) {0, 0, -1, 0};
             }
-
-            if (maze[i][j].left_wall) {
-                for (int segment = 0; segment < 3; ++segment) {
-                    int wall_height = rand_between(3, 6);
-                    for (int h = 0; h < wall_height; ++h) {
-                        for (int k = 0; k < num_vertices_per_block; ++k) {
-                            temp_positions[index] = block_positions[k];
-                            temp_positions[index].x += x_cell - 2.0f * block_size;  //...for left wall
-                            temp_positions[index].y += base_height + h * block_size;
-                            temp_positions[index].z += z_cell + (segment - 1) * block_size;
-                            temp_tex_coords[index] = block_tex_coords[k];
-                            index++;
-                        }
-                    }
-                }
+            else if(j > 23 && j <= 29){
+                normals[i + j] = (vec4) {0, 1, 0, 0};
             }
-
-            if (maze[i][j].right_wall) {
-                for (int segment = 0; segment < 3; ++segment) {
-                    int wall_height = rand_between(3, 6);
-                    for (int h = 0; h < wall_height; ++h) {
-                        for (int k = 0; k < num_vertices_per_block; ++k) {
-                            temp_positions[index] = block_positions[k];
-                            temp_positions[index].x += x_cell + 2.0f * block_size;  //...for right wall
-                            temp_positions[index].y += base_height + h * block_size;
-                            temp_positions[index].z += z_cell + (segment - 1) * block_size;
-                            temp_tex_coords[index] = block_tex_coords[k];
-                            index++;
-                        }
-                    }
-                }
+            else{
+                normals[i + j] = (vec4) {0, -1, 0, 0};
             }
         }
     }
+}
 
-    // update global positions and tex_coords as usual
-    int wall_vertices = index; 
+// copy the scene into the vertex buffer bound in init, again whenever build_scene changed it
+void upload_scene() {
+    // Calculate sizes for positions and texture coordinates
+    size_t size_positions = sizeof(vec4) * num_vertices; 
+    size_t size_text_coords = sizeof(vec2) * num_vertices;
 
-    positions = (vec4 *)realloc(positions, sizeof(vec4) * (num_vertices + wall_vertices));
-    tex_coords = (vec2 *)realloc(tex_coords, sizeof(vec2) * (num_vertices + wall_vertices));
+    glBufferData(GL_ARRAY_BUFFER, size_positions * 2 + size_text_coords, NULL, GL_STATIC_DRAW);
 
-    if (!positions || !tex_coords) {
-        fprintf(stderr, "Failed to reallocate memory for maze wall vertices.\n");
-        exit(EXIT_FAILURE);
-    }
+    glBufferSubData(GL_ARRAY_BUFFER, 0, size_positions, positions);
+    glBufferSubData(GL_ARRAY_BUFFER, size_positions, size_positions, normals);
+    glBufferSubData(GL_ARRAY_BUFFER, size_positions * 2, size_text_coords, tex_coords);
 
-    memcpy(positions + num_vertices, temp_positions, sizeof(vec4) * wall_vertices);
-    memcpy(tex_coords + num_vertices, temp_tex_coords, sizeof(vec2) * wall_vertices);
+    GLuint vPosition = glGetAttribLocation(program, "vPosition");
+    glEnableVertexAttribArray(vPosition);
+    glVertexAttribPointer(vPosition, 4, GL_FLOAT, GL_FALSE, 0, (GLvoid *) (0));
 
-    num_vertices += wall_vertices;  // update total vert count
+    GLuint vNormal = glGetAttribLocation(program, "vNormal");
+    glEnableVertexAttribArray(vNormal);
+    glVertexAttribPointer(vNormal, 4, GL_FLOAT, GL_FALSE, 0, (GLvoid *) (size_positions));
 
-    free(temp_positions);
-    free(temp_tex_coords);
+    GLuint vTexCoord = glGetAttribLocation(program, "vTexCoord");
+    glEnableVertexAttribArray(vTexCoord);
+    glVertexAttribPointer(vTexCoord, 2, GL_FLOAT, GL_FALSE, 0, (GLvoid *) (2 * size_positions));
 }
 
-//function to bring all maze parts together and display them
-void display_maze(int maze_x, int maze_z) {
-    generate_maze_floor(maze_x, maze_z);
-    generate_maze_poles(maze_x, maze_z);
-    generate_maze_walls(maze_x, maze_z);
+// copy just vertices [first, first + count) into the buffer, the normals only depend on the index in the block
+void upload_vertices(int first, int count) {
+    size_t size_positions = sizeof(vec4) * num_vertices;
+    glBufferSubData(GL_ARRAY_BUFFER, sizeof(vec4) * first, sizeof(vec4) * count, positions + first);
+    glBufferSubData(GL_ARRAY_BUFFER, size_positions * 2 + sizeof(vec2) * first, sizeof(vec2) * count, tex_coords + first);
 }
 
 void init(void)
 {
-    GLuint program = initShader("vshader.glsl", "fshader.glsl");
+    program = initShader("vshader.glsl", "fshader.glsl");
     glUseProgram(program);
 
-    init_grassblock();
-    generate_pyramid(x_size, z_size);
-    display_maze(maze_x_size, maze_z_size);
-    display_sun();
+    build_scene();
 
     //model_view = look_at((vec4) {0, 0, maze_z_size * 3, 1}, (vec4) {0, 0, maze_z_size * 3 - 1, 1}, (vec4) {0, 1, 0, 0});
     eye = (vec4) {0, 0, maze_z_size * 3, 1};
@@ -653,30 +370,6 @@ void init(void)
     model_view = look_at(eye, at, up);
     projection = frustum(-1, 1, -1, 1, -1, -100);
 
-    normals = (vec4 *) malloc(sizeof(vec4) * num_vertices);
-    for(int i = 0; i < num_vertices; i += 36){
-        for(int j = 0; j < 36; j++){
-            if(j <= 5){
-                normals[i + j] = (vec4) {0, 0, 1, 0};
-            }
-            else if(j > 5 && j <= 11){
-                normals[i + j] = (vec4) {1, 0, 0, 0};
-            }
-            else if(j > 11 && j <= 17){
-                normals[i + j] = (vec4) {-1, 0, 0, 0};
-            }
-            else if(j > 17 && j <= 23){
-                normals[i + j] = (vec4) {0, 0, -1, 0};
-            }
-            else if(j > 23 && j <= 29){
-                normals[i + j] = (vec4) {0, 1, 0, 0};
-            }
-            else{
-                normals[i + j] = (vec4) {0, -1, 0, 0};
-            }
-        }
-    }
-
     int tex_width = 64;
     int tex_height = 64;
     GLubyte my_texels[tex_width][tex_height][3];
@@ -699,10 +392,6 @@ void init(void)
     int param;
     glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &param);
 
-    // Calculate sizes for positions and texture coordinates
-    size_t size_positions = sizeof(vec4) * num_vertices; 
-    size_t size_text_coords = sizeof(vec2) * num_vertices;
-
     GLuint vao;
     #ifdef __APPLE__
     glGenVertexArraysAPPLE(1, &vao);
@@ -715,23 +404,7 @@ void init(void)
     GLuint buffer;
     glGenBuffers(1, &buffer);
     glBindBuffer(GL_ARRAY_BUFFER, buffer);
-    glBufferData(GL_ARRAY_BUFFER, size_positions * 2 + size_text_coords, NULL, GL_STATIC_DRAW);
-
-    glBufferSubData(GL_ARRAY_BUFFER, 0, size_positions, positions);
-    glBufferSubData(GL_ARRAY_BUFFER, size_positions, size_positions, normals);
-    glBufferSubData(GL_ARRAY_BUFFER, size_positions * 2, size_text_coords, tex_coords);
-
-    GLuint vPosition = glGetAttribLocation(program, "vPosition");
-    glEnableVertexAttribArray(vPosition);
-    glVertexAttribPointer(vPosition, 4, GL_FLOAT, GL_FALSE, 0, (GLvoid *) (0));
-
-    GLuint vNormal = glGetAttribLocation(program, "vNormal");
-    glEnableVertexAttribArray(vNormal);
-    glVertexAttribPointer(vNormal, 4, GL_FLOAT, GL_FALSE, 0, (GLvoid *) (size_positions));
-
-    GLuint vTexCoord = glGetAttribLocation(program, "vTexCoord");
-    glEnableVertexAttribArray(vTexCoord);
-    glVertexAttribPointer(vTexCoord, 2, GL_FLOAT, GL_FALSE, 0, (GLvoid *) (2 * size_positions));
+    upload_scene();
 
     GLuint texture_location = glGetUniformLocation(program, "texture");
     glUniform1i(texture_location, 0);
@@ -766,77 +439,6 @@ void init(void)
     glDepthRange(1,0);
 }
 
-void init_block(){
-    if (block_positions == NULL) {
-        block_positions = (vec4 *) malloc(sizeof(vec4) * num_vertices_per_block);
-        if (block_positions == NULL) {
-            fprintf(stderr, "Failed to allocate memory for block_positions.\n");
-            exit(EXIT_FAILURE);
-        }
-    }
-    
-    if (block_tex_coords == NULL) {
-        block_tex_coords = (vec2 *) malloc(sizeof(vec2) * num_vertices_per_block);
-        if (block_tex_coords == NULL) {
-            fprintf(stderr, "Failed to allocate memory for block_tex_coords.\n");
-            exit(EXIT_FAILURE);
-        }
-    }
-
-    block_positions[0] = (vec4) {.25, -.25,  0.0,  1.0}; 
-    block_positions[1] = (vec4) {-0.25,  0.25,  0.0,  1.0}; 
-    block_positions[2] = (vec4) {-0.25, -.25,  0.0,  1.0}; 
-    block_positions[3] = (vec4) {.25, -.25,  0.0,  1.0}; 
-    block_positions[4] = (vec4) { .25, 0.25,  0.0,  1.0}; 
-    block_positions[5] = (vec4) {-0.25,  0.25,  0.0,  1.0}; 
-
-    //ls 
-    block_positions[6] = (vec4) {.25, -.25,  -.5,  1.0}; 
-    block_positions[7] =  (vec4) {.25, .25,  0.0,  1.0}; 
-    block_positions[8] =  (vec4) {.25, -.25,  0.0,  1.0}; 
-    block_positions[9] = (vec4) {.25, -.25,  -.5,  1.0}; 
-    block_positions[10] =  (vec4) {.25, .25,  -.5,  1.0}; 
-    block_positions[11] =  (vec4) {.25, .25,  0.0,  1.0}; 
-
-    //rs 
-    block_positions[12] = (vec4) {-.25, -.25,  0,  1.0}; 
-    block_positions[13] =  (vec4) {-.25, .25,  0.0,  1.0}; 
-    block_positions[14] =  (vec4) {-.25, -.25,  -0.5,  1.0}; 
-    block_positions[15] = (vec4) {-.25, .25,  0,  1.0}; 
-    block_positions[16] =  (vec4) {-.25, .25,  -.5,  1.0}; 
-    block_positions[17] =  (vec4) {-.25, -.25,  -0.5,  1.0}; 
-
-    //bs 
-    block_positions[18] = (vec4) {-.25, -.25,  -.5,  1.0}; 
-    block_positions[19] =  (vec4) {-.25, .25,  -.5,  1.0}; 
-    block_positions[20] =  (vec4) {.25, -.25,  -0.5,  1.0}; 
-    block_positions[21] = (vec4) {-.25, .25,  -.5,  1.0}; 
-    block_positions[22] =  (vec4) {.25, .25,  -.5,  1.0}; 
-    block_positions[23] =  (vec4) {.25, -.25,  -.5,  1.0}; 
-
-    //top
-    block_positions[24] = (vec4) {.25, .25,  0,  1.0}; 
-    block_positions[25] =  (vec4) {.25, .25,  -.5,  1.0}; 
-    block_positions[26] =  (vec4) {-.25, .25,  -0,  1.0}; 
-    block_positions[27] = (vec4) {.25, .25,  -.5,  1.0}; 
-    block_positions[28] =  (vec4) {-.25, .25,  -.5,  1.0}; 
-    block_positions[29] =  (vec4) {-.25, .25,  0,  1.0}; 
-
-    //bottom
-    block_positions[30] = (vec4) {.25, -.25,  -.5,  1.0}; 
-    block_positions[31] =  (vec4) {.25, -.25,  0,  1.0}; 
-    block_positions[32] =  (vec4) {-.25, -.25,  -0.5,  1.0}; 
-    block_positions[33] = (vec4) {.25, -.25,  -0,  1.0}; 
-    block_positions[34] =  (vec4) {-.25, -.25,  -0,  1.0}; 
-    block_positions[35] =  (vec4) {-.25, -.25,  -.5,  1.0}; 
-
-    for (int i = 0; i < num_vertices_per_block; ++i) {
-        block_positions[i].x *= scale_cube;
-        block_positions[i].y *= scale_cube;
-        block_positions[i].z *= scale_cube;
-    }
-}
-
 void init_grassblock() {
     init_block(); 
 
@@ -884,57 +486,7 @@ void init_grassblock() {
     block_tex_coords[35] = (vec2) {0.75, 1};
 }
 
-void init_texture(float rcornerX, float rcornerY){
-    //front
-    block_tex_coords[0] = (vec2) {rcornerX, rcornerY};
-    block_tex_coords[1] = (vec2) {rcornerX - .25, rcornerY - .25};
-    block_tex_coords[2] = (vec2) {rcornerX - .25, rcornerY};
-    block_tex_coords[3] = (vec2) {rcornerX, rcornerY};
-    block_tex_coords[4] = (vec2) {rcornerX, rcornerY - .25};
-    block_tex_coords[5] = (vec2) {rcornerX - .25, rcornerY - .25};
-
-    //ls
-    block_tex_coords[6] = (vec2) {rcornerX, rcornerY};
-    block_tex_coords[7] = (vec2) {rcornerX - .25, rcornerY - .25};
-    block_tex_coords[8] = (vec2) {rcornerX - .25, rcornerY};
-    block_tex_coords[9] = (vec2) {rcornerX, rcornerY};
-    block_tex_coords[10] = (vec2) {rcornerX, rcornerY - .25};
-    block_tex_coords[11] = (vec2) {rcornerX - .25, rcornerY - .25};
-
-    //rs
-    block_tex_coords[12] = (vec2) {rcornerX, rcornerY};
-    block_tex_coords[13] = (vec2) {rcornerX, rcornerY - .25};
-    block_tex_coords[14] = (vec2) {rcornerX - .25, rcornerY};
-    block_tex_coords[15] = (vec2) {rcornerX, rcornerY - .25};
-    block_tex_coords[16] = (vec2) {rcornerX - .25, rcornerY - .25};
-    block_tex_coords[17] = (vec2) {rcornerX - .25, rcornerY};
-
-    //bs
-    block_tex_coords[18] = (vec2) {rcornerX, rcornerY};
-    block_tex_coords[19] = (vec2) {rcornerX, rcornerY - .25};
-    block_tex_coords[20] = (vec2) {rcornerX - .25, rcornerY};
-    block_tex_coords[21] = (vec2) {rcornerX, rcornerY - .25};
-    block_tex_coords[22] = (vec2) {rcornerX - .25, rcornerY - .25};
-    block_tex_coords[23] = (vec2) {rcornerX - .25, rcornerY};
-
-    //top
-    block_tex_coords[24] = (vec2) {rcornerX, rcornerY};
-    block_tex_coords[25] = (vec2) {rcornerX, rcornerY - .25};
-    block_tex_coords[26] = (vec2) {rcornerX - .25, rcornerY};
-    block_tex_coords[27] = (vec2) {rcornerX, rcornerY - .25};
-    block_tex_coords[28] = (vec2) {rcornerX - .25, rcornerY - .25};
-    block_tex_coords[29] = (vec2) {rcornerX - .25, rcornerY};
-
-    //bottom
-    block_tex_coords[30] = (vec2) {rcornerX, rcornerY};
-    block_tex_coords[31] = (vec2) {rcornerX, rcornerY - .25};
-    block_tex_coords[32] = (vec2) {rcornerX - .25, rcornerY};
-    block_tex_coords[33] = (vec2) {rcornerX, rcornerY - .25};
-    block_tex_coords[34] = (vec2) {rcornerX - .25, rcornerY - .25};
-    block_tex_coords[35] = (vec2) {rcornerX - .25, rcornerY};
-}
-
-void generate_pyramid(int x_size, int z_size) {
+void generate_pyramid(int x_size, int z_size, Rng *rng) {
     int layers_x = x_size;
     int layers_z = z_size;
     int layers = (layers_x < layers_z) ? layers_x : layers_z;
@@ -975,13 +527,13 @@ void generate_pyramid(int x_size, int z_size) {
             for (int j = 0; j < blocks_per_layer_z; ++j) {
                 bool is_edge_block = (i == 0 || i == blocks_per_layer_x - 1 || j == 0 || j == blocks_per_layer_z - 1);
 
-                if (layer == 0 && is_edge_block && (rand() % 2 == 0)) {
+                if (layer == 0 && is_edge_block && (rng_between(rng, 0, 2) == 0)) {
                     // 50% chance to exclude edge block on layer 0
                     continue; // Skip this block
                 }
 
                 // For layers > 0, randomly decide whether to include the block
-                if (layer > 0 && (rand() % 100 < 53)) {
+                if (layer > 0 && (rng_between(rng, 0, 100) < 53)) {
                     // 53% chance to exclude block
                     continue; // Skip this block
                 }
@@ -1082,7 +634,7 @@ void idle() {
 
         }
         else if (forward_animation) {
-            if (num_steps > max_steps) {
+            if (num_steps > forward_steps) {
                 // end animation
                 is_animating = 0;
                 forward_animation = 0;
@@ -1096,7 +648,7 @@ void idle() {
                 num_steps = 0;
             } else {
                 //tried to replicate what was described on the project page
-                float alpha = (float)num_steps / max_steps;
+                float alpha = (float)num_steps / forward_steps;
 
                 temp_eye.x = (1 - alpha) * eye.x + alpha * target_eye_x;
                 temp_eye.y = 2;
@@ -1267,16 +819,14 @@ void idle() {
     if (!is_animating) {
         process_next_movement();
     }
+    solver_idle(); // joins the 'z' solve once it has found the route
+    if (route_in_progress) {
+        feed_route();
+    }
     
-    // Auto-solve maze using left-hand rule if enabled
-    if (maze_solving_in_progress && !is_animating && queue_front == queue_back) {
-        // Check if maze is solved (player has exited through the exit)
-        if (!inside_maze && (player_row == 0 && player_col == maze_x_size - 1) && direction == 0) {
-            maze_solving_in_progress = 0; // Stop auto-solving
-            printf("Maze solved using left-hand rule!\n");
-        } else {
-            solve_maze_lh(); // Continue solving
-        }
+    // Replay the left-hand rule walk if enabled
+    if (maze_solving_in_progress) {
+        feed_left_hand();
     }
     
     if (resetting && reset_step < reset_steps) {
@@ -1341,64 +891,69 @@ void resetPlatform() {
     }
 }
 
-void solve_maze_lh() {
-    // Don't execute if currently animating or if there are queued movements
-    if (is_animating || queue_front != queue_back) {
+// work out the whole left-hand rule walk from where the player is and start replaying it
+void start_left_hand() {
+    if (player_row < 0 || player_col < 0) {
+        fprintf(stderr, "Press 'f' to go to the start of the maze first.\n");
         return;
     }
-    
-    // Step 1: Handle entry into maze
+    if (!solver_idle()) {
+        printf("Still working out the route to the exit.\n");
+        return;
+    }
+    route_in_progress = 0;
+    move_queue_clear(&movement_queue); // whatever was queued belongs to some other plan
+
+    int start_direction = direction;
     if (!inside_maze) {
-        // Turn to face north if not already facing north
-        if (direction != 0) {
-            enqueue_movement(TURN_LEFT);
-            return;
-        } else {
-            // Facing north, now enter the maze
-            enqueue_movement(MOVE_FORWARD);
-            return;
-        }
+        // if outside, turn to face north and move forward into the maze
+        enqueue_turn(start_direction, 0);
+        start_direction = 0;
+        enqueue_movement(MOVE_FORWARD);
     }
-    
-    // Step 2: Check if we've reached the exit
-    if (player_row == 0 && player_col == maze_x_size - 1) {
-        // At the exit, face north and exit
-        if (direction != 0) {
-            enqueue_movement(TURN_LEFT);
-            return;
-        } else {
-            enqueue_movement(MOVE_FORWARD); // Exit the maze
-            return;
+
+    double start = now_seconds();
+    CellPos player = {player_row, player_col};
+    walk_left_hand(&maze, player, start_direction, maze_exit(&maze), &lh_walk);
+    double ms = (now_seconds() - start) * 1000.0;
+    printf("Left-hand rule: %ld steps and %ld turns worked out in %.3f ms", lh_walk.steps, lh_walk.turns, ms);
+    if (lh_walk.result == WALK_REACHED_GOAL) printf(", reaches the exit.\n");
+    else if (lh_walk.result == WALK_LOOPED) printf(", then it goes round a loop of %ld steps.\n", lh_walk.loop_steps);
+    else printf(", then it is back at the entrance.\n");
+
+    lh_next = 0;
+    maze_solving_in_progress = 1;
+}
+
+// keep a few hundred moves of the walk queued, and walk out of the exit once it has all been played
+void feed_left_hand() {
+    MovementType moves[] = {MOVE_FORWARD, TURN_LEFT, TURN_RIGHT}; // by WalkMove
+    while (lh_next < lh_walk.num_moves && move_queue_size(&movement_queue) < QUEUE_AHEAD) {
+        if (lh_walk.moves[lh_next] != WALK_FORWARD) {
+            enqueue_movement(moves[lh_walk.moves[lh_next++]]);
+            continue;
         }
+        // steps in a row go as one run
+        int cells = 0;
+        while (lh_next < lh_walk.num_moves && lh_walk.moves[lh_next] == WALK_FORWARD) {
+            lh_next++;
+            cells++;
+        }
+        enqueue_forward(cells);
     }
-    
-    // Step 3: Implement proper left-hand rule
-    // Left-hand rule: Always try left first, then straight, then right, then turn around
-    
-    int left_direction = (direction + 3) % 4;  // Turn left from current direction
-    int right_direction = (direction + 1) % 4; // Turn right from current direction
-    
-    if (can_move_inside_maze(player_row, player_col, left_direction)) {
-        // Can turn left - this is the preferred direction in left-hand rule
-        // Queue both turn left AND move forward to ensure proper sequencing
-        enqueue_movement(TURN_LEFT);
-        enqueue_movement(MOVE_FORWARD);
-    } else if (can_move_inside_maze(player_row, player_col, direction)) {
-        // Can't turn left, but can go straight
-        enqueue_movement(MOVE_FORWARD);
-    } else if (can_move_inside_maze(player_row, player_col, right_direction)) {
-        // Can't go left or straight, try right
-        // Queue turn right AND move forward
-        enqueue_movement(TURN_RIGHT);
+    if (lh_next < lh_walk.num_moves || is_animating || move_queue_size(&movement_queue) > 0) return;
+
+    if (lh_walk.result == WALK_REACHED_GOAL && inside_maze) {
+        // At the exit, face north and exit
+        enqueue_turn(direction, 0);
         enqueue_movement(MOVE_FORWARD);
-    } else {
-        // Dead end - turn around
-        // Turn right twice to face the opposite direction
-        enqueue_movement(TURN_RIGHT);
-        enqueue_movement(TURN_RIGHT);
+        return;
     }
-    
-    glutPostRedisplay();
+
+    maze_solving_in_progress = 0; // Stop auto-solving
+    if (lh_walk.result == WALK_REACHED_GOAL) printf("Maze solved using left-hand rule!\n");
+    else if (lh_walk.result == WALK_LOOPED) printf("Left-hand rule stopped, it would only go round the loop again.\n");
+    else printf("Left-hand rule stopped, it can't reach the exit from here.\n");
 }
 
 void display(void)
@@ -1513,6 +1068,7 @@ void keyboard(unsigned char key, int mousex, int mousey) {
         glutPostRedisplay();
     }
     else if (key == 'f') { // Go to start of maze
+        if (moves_locked()) return;
         eye.x = -maze_x_size + 1;
         at.x = -maze_x_size + 1;
         eye.z = maze_z_size + 1;
@@ -1542,13 +1098,18 @@ void keyboard(unsigned char key, int mousex, int mousey) {
         print_location();
     }
     else if (key == 'e') {
+        if (moves_locked()) return;
         turn_left();
     }
     else if (key == 'r') {
+        if (moves_locked()) return;
         turn_right();
     }
     else if (key == 'z') {
-        shortest_path(player_row, player_col, direction, inside_maze);
+        start_solve();
+    }
+    else if (key == 'x') { // debug: toggle the wall in front of the player
+        toggle_wall_ahead();
     }
     else if (key == ' ') { // Reset platform
         resetPlatform();
@@ -1557,11 +1118,12 @@ void keyboard(unsigned char key, int mousex, int mousey) {
         if (maze_solving_in_progress) {
             // Stop automatic solving
             maze_solving_in_progress = 0;
+            move_queue_clear(&movement_queue);
             printf("Left-hand rule auto-solving stopped.\n");
         } else {
             // Start automatic solving
-            maze_solving_in_progress = 1;
-            printf("Left-hand rule auto-solving started. Press 'k' again to stop.\n");
+            start_left_hand();
+            if (maze_solving_in_progress) printf("Left-hand rule auto-solving started. Press 'k' again to stop.\n");
         }
     }
     else if (key == 'l') {
@@ -1717,6 +1279,7 @@ void motion(int x, int y) {
 }
 
 void special(int key, int x, int y) {
+    if (moves_locked()) return;
     if(key == GLUT_KEY_UP){
         forward();
         print_location();
@@ -1736,138 +1299,122 @@ void special(int key, int x, int y) {
 
 }
 
-//shortest path alg using breadth-first search algorithm
+//queue the next runs of the route: the shortest turn at every corner and one move per straight run
+void feed_route() {
+    PathRun run;
+    while (move_queue_size(&movement_queue) < QUEUE_AHEAD) {
+        if (!route_cursor_next(&route, &run)) {
+            // the runs brought us to the exit, but we still have to walk thru the exit
+            enqueue_turn(route_direction, 0);
+            enqueue_movement(MOVE_FORWARD);
+            route_in_progress = 0;
+            return;
+        }
+        enqueue_turn(route_direction, run.direction);
+        route_direction = run.direction;
+        enqueue_forward((int)run.length);
+    }
+}
+
+//solve from where the player is with path_solver (the exit distance field unless --solver says otherwise)
 void shortest_path(int player_row, int player_col, int direction, bool inside_maze) {
+    if (player_row < 0 || player_col < 0) {
+        fprintf(stderr, "Press 'f' to go to the start of the maze first.\n");
+        return;
+    }
+
     //to start, handle case when player starts outside the map
     if (!inside_maze) {
         // if outside, turn to face north and move forward into the maze
-        while (direction != 0) {
-            enqueue_movement(TURN_LEFT);
-            direction = (direction + 3) % 4; // update direction counterclockwise bc we arent updating global variables in this
-        }
+        enqueue_turn(direction, 0);
+        direction = 0; // bc we arent updating global variables in this
         enqueue_movement(MOVE_FORWARD);
     }
 
-    // BFS setup
-    int queue_size = maze_z_size * maze_x_size;
-    Node queue[queue_size]; // stores nodes to visit next
-    int front = 0, back = 0; //track front and end of queue
-
-    // visited grid and parent tracking
-    bool visited[maze_z_size][maze_x_size]; //keeps track of whether a cell has already been processed to avoid revisiting
-    memset(visited, false, sizeof(visited));
-
-    Node parents[maze_z_size][maze_x_size]; //tracks parent of each cell, this is used to reconstruct the path later
-
-    // add starting node to the queue
-    queue[back++] = (Node){player_row, player_col, -1, -1}; //add player curr position as first node in queue
-    visited[player_row][player_col] = true; //then mark it as visited
-
-    Node exit_node = {-1, -1, -1, -1};
-    bool found_exit = false;
-
-    // BFS loop
-    while (front < back) {
-        Node current = queue[front++];
-        int row = current.row;
-        int col = current.col;
-
-        // check if we at the exit
-        if (row == 0 && col == maze_x_size - 1) { // <-- exit position
-            exit_node = current;
-            found_exit = true;
-            break;
+    //edge case for if the solver couldnt find the end, this should never happen
+    route_ready = false;
+    CellPos player = {player_row, player_col};
+    if (path_solver->solve == solve_field) {
+        // the field already says which way to go from every cell, the route is read straight off it as it is
+        // walked and no path is built
+        long expanded = 0;
+        if (!goal_field_reach(&solver_ws.field, &maze, player, maze_exit(&maze), &expanded)) {
+            fprintf(stderr, "No path to the exit found!\n");
+            return;
         }
-
-        // not at exit, explore the 4 neighboring units
-        for (int dir = 0; dir < 4; dir++) {
-            int new_row = row + d_row[dir]; //the d_row and d_col offset arrays find the correct neighboring cells based on the direction we are looking at
-            int new_col = col + d_col[dir];
-
-            // check that: its within bounds, it hasnt been visited, and its not blocked by a wall in the given direction
-            if (new_row >= 0 && new_row < maze_z_size && new_col >= 0 && new_col < maze_x_size &&
-                !visited[new_row][new_col] &&
-                ((dir == 0 && !maze[row][col].top_wall) ||    // north wall
-                 (dir == 1 && !maze[row][col].right_wall) ||  // east
-                 (dir == 2 && !maze[row][col].bottom_wall) || // south
-                 (dir == 3 && !maze[row][col].left_wall))) {  // west
-                //this is the biggest if statement condition ive ever made haha
-                
-                //add the valid neighbors to the queue and mark them as visited
-                //then update parents array to track how each cell was reached
-                queue[back++] = (Node){new_row, new_col, row, col};
-                visited[new_row][new_col] = true;
-                parents[new_row][new_col] = current;
-            }
+        printf("%s: %d cells, %ld expanded\n", path_solver->name,
+               goal_field_distance(&solver_ws.field, player) + 1, expanded);
+        route_cursor_field(&route, &solver_ws.field, player);
+    } else {
+        if (!path_solver->solve(&maze, player, maze_exit(&maze), &solver_ws, &solver_path)) {
+            fprintf(stderr, "No path to the exit found!\n");
+            return;
         }
+        printf("%s: %d cells, %ld expanded\n", path_solver->name, solver_path.length, solver_path.expanded);
+        route_cursor_path(&route, &solver_path);
     }
-    //edge case for if the BFS couldnt find the end, this should never happen
-    if (!found_exit) {
-        fprintf(stderr, "No path to the exit found!\n");
+    route_direction = direction;
+    route_ready = true;
+}
+
+//debug key: put up or knock down the wall the player is facing, then fix the route to the exit. d* lite keeps
+//its search between changes, so after the first time only the cells the wall really affects are looked at again
+void toggle_wall_ahead() {
+    if (player_row < 0 || player_col < 0 || !inside_maze) {
+        fprintf(stderr, "Walk into the maze first, the wall in front of you is the one that changes.\n");
         return;
     }
-
-    // reconstruct the path from exit to start
-    Node path[queue_size];
-    int path_length = 0;
-
-    //start from exit node, use parents array to trace back to start, store each node in the path array
-    for (Node current = exit_node; current.parent_row != -1; current = parents[current.row][current.col]) {
-        path[path_length++] = current;
+    int row = player_row + d_row[direction];
+    int col = player_col + d_col[direction];
+    if (row < 0 || row >= maze_z_size || col < 0 || col >= maze_x_size) {
+        fprintf(stderr, "The outer wall stays where it is.\n");
+        return;
     }
-
-    // reverse the path for navigation
-    for (int i = 0; i < path_length / 2; i++) {
-        Node temp = path[i];
-        path[i] = path[path_length - 1 - i];
-        path[path_length - 1 - i] = temp;
+    if (!solver_idle()) {
+        printf("Still working out the route to the exit.\n");
+        return;
     }
 
-    // now navigate thru the path
-    for (int i = 0; i < path_length; i++) {
-        Node next = path[i];
-        int target_row = next.row;
-        int target_col = next.col;
-
-        // find the direction needed to face the target
-        int target_direction = -1;
-        if (target_row < player_row) target_direction = 0; // north
-        else if (target_col > player_col) target_direction = 1; // east
-        else if (target_row > player_row) target_direction = 2; // south
-        else if (target_col < player_col) target_direction = 3; // west
-
-        // then rotate to face the target direction
-        while (direction != target_direction) {
-            enqueue_movement(TURN_RIGHT);
-            direction = (direction + 1) % 4; // update direction 
-        }
-
-        // once facing traget, move forward into target cell
-        enqueue_movement(MOVE_FORWARD);
-
-        // then update the player's current position
-        player_row = target_row;
-        player_col = target_col;
+    bool wall = maze_toggle_wall(&maze, player_row, player_col, direction);
+    workspace_wall_changed(&solver_ws, &maze, player_row, player_col, direction);
+    int first, count;
+    if (mesh_set_wall(&maze, player_row, player_col, direction, &rng, &first, &count)) {
+        upload_vertices(first, count);
+    } else {
+        // out of spare wall slots, start over with fresh ones
+        build_scene();
+        upload_scene();
     }
+    glutPostRedisplay();
 
-    // the above function should bring us to the exit, but we still have to walk thru the exit
-    //if we arent already facing the exit, turn until we are
-    while (direction != 0) {
-        enqueue_movement(TURN_LEFT);
-        direction = (direction + 3) % 4; // update direction
+    // a route that is being walked is swapped for the repaired one, the left hand walk is worked out again
+    if (maze_solving_in_progress) start_left_hand();
+    bool walking = route_in_progress || (move_queue_size(&movement_queue) > 0 && !maze_solving_in_progress);
+    if (walking) {
+        route_in_progress = 0;
+        move_queue_clear(&movement_queue);
     }
 
-    // once facing the exit, move forward and we are done
-    enqueue_movement(MOVE_FORWARD);
+    double start = now_seconds();
+    CellPos player = {player_row, player_col};
+    bool found = solve_dstar(&maze, player, maze_exit(&maze), &solver_ws, &solver_path);
+    double ms = (now_seconds() - start) * 1000.0;
+    if (!found) {
+        printf("%s the wall, the exit cant be reached from here now (%.3f ms)\n", wall ? "Put up" : "Knocked down", ms);
+        return;
+    }
+    printf("%s the wall, %d cells to the exit (%ld cells searched in %.3f ms)\n", wall ? "Put up" : "Knocked down",
+           solver_path.length, solver_path.expanded, ms);
+    if (walking) {
+        route_cursor_path(&route, &solver_path);
+        route_direction = direction;
+        route_in_progress = 1;
+    }
 }
 
 //collision detection
 bool can_move_inside_maze(int row, int col, int direction) {
-    if (direction == 0 && maze[row][col].top_wall) return false;    // north
-    if (direction == 1 && maze[row][col].right_wall) return false; // east
-    if (direction == 2 && maze[row][col].bottom_wall) return false; // south
-    if (direction == 3 && maze[row][col].left_wall) return false;  // west
-    return true;
+    return !maze_has_wall(&maze, row, col, direction);
 }
 
 bool can_reenter_maze(int exit_direction, int current_direction, char movement_type) {
@@ -1952,11 +1499,40 @@ void forward() {
     if (can_animate) {
         // start animation
         forward_animation = 1;
+        forward_steps = max_steps;
         num_steps = 0;
         is_animating = 1;
     }
 }
 
+//walk up to cells cells straight ahead in one animation. every cell after the first adds a quarter of a
+//single move's time, up to three moves' worth, so long corridors play back quickly
+void forward_run(int cells) {
+    if (is_animating) {
+        return;
+    }
+    if (cells <= 1 || !inside_maze) {
+        forward();
+        return;
+    }
+
+    int moved = 0;
+    while (moved < cells && can_move_inside_maze(player_row, player_col, direction)) {
+        player_row += d_row[direction];
+        player_col += d_col[direction];
+        moved++;
+    }
+    if (moved == 0) return;
+    target_eye_x = eye.x + 2 * moved * d_col[direction]; target_at_x = at.x + 2 * moved * d_col[direction];
+    target_eye_z = eye.z + 2 * moved * d_row[direction]; target_at_z = at.z + 2 * moved * d_row[direction];
+
+    forward_animation = 1;
+    forward_steps = max_steps + (moved - 1) * max_steps / 4;
+    if (forward_steps > 3 * max_steps) forward_steps = 3 * max_steps;
+    num_steps = 0;
+    is_animating = 1;
+}
+
 void backward() {
     if (is_animating) {
         return;
@@ -2285,6 +1861,11 @@ void prompt_user() {
         fprintf(stderr, "Invalid input. Maze depth must be a positive integer.\n");
         exit(EXIT_FAILURE);
     }
+    set_platform_size();
+}
+
+// platform around the maze, a few blocks bigger than the maze itself
+void set_platform_size() {
     x_size = (maze_x_size * 3 + maze_x_size + 1) + 10;
     z_size = (maze_z_size * 3 + maze_z_size + 1) + 10;
 }
@@ -2294,18 +1875,106 @@ void cleanup() {
     if (tex_coords) free(tex_coords);
     if (block_positions) free(block_positions);
     if (block_tex_coords) free(block_tex_coords);
-    free_maze(maze_z_size);
+    if (__atomic_load_n(&solve_state, __ATOMIC_ACQUIRE) != 0) pthread_join(solve_thread, NULL);
+    free_maze(&maze);
+    workspace_free(&solver_ws);
+    path_free(&solver_path);
+    wall_walk_free(&lh_walk);
+    move_queue_free(&movement_queue);
 }
 
 int main(int argc, char **argv)
 {
-    prompt_user();
-    srand(time(NULL));
+    // --threads N generates on N threads (same maze for any N) and sets the solvers' threads,
+    // --seed N makes the run reproducible,
+    // --headless generates/solves mazes from the command line without ever touching GL,
+    // --generator eller --stream writes them row by row without holding the maze in memory,
+    // --save FILE / --load FILE keep a maze in the binary format (maze_file.h) instead of regenerating it,
+    // --export FILE writes a .txt/.pbm/.svg picture of it.
+    // the options are parsed by headless_parse_args(), the same as ./maze_headless
+    HeadlessOptions headless_opts = {.count = 1, .threads = 1};
+    headless_opts.seed = (uint64_t)time(NULL);
+    if (!headless_parse_args(argc, argv, &headless_opts)) {
+        return EXIT_FAILURE;
+    }
+    seed = headless_opts.seed;
+    int gen_threads = headless_opts.threads;
+    const char *load_file = headless_opts.load;
+    const char *save_file = headless_opts.save;
+    const char *export_file = headless_opts.export_file;
+    workspace_init(&solver_ws);
+    path_init(&solver_path);
+    move_queue_init(&movement_queue);
+
+    solver_ws.num_threads = gen_threads;
+
+    if (headless_opts.headless) {
+        if (!headless_opts.solver) headless_opts.solver = "bfs";
+        return run_headless(&headless_opts);
+    }
+
+    // the exit never moves, so by default 'z' follows a distance field built from it once
+    path_solver = find_solver(headless_opts.solver ? headless_opts.solver : "field");
+    if (!path_solver) {
+        fprintf(stderr, "Unknown solver '%s'. Available solvers: ", headless_opts.solver);
+        list_solvers(stderr);
+        exit(EXIT_FAILURE);
+    }
+
+    if (load_file) {
+        // the walls come straight from the mapped file, the seed is only used for the scenery
+        MazeFileHeader header;
+        double load_start = now_seconds();
+        if (!maze_load(&maze, load_file, &header)) {
+            exit(EXIT_FAILURE);
+        }
+        seed = header.seed;
+        maze_x_size = maze.cols;
+        maze_z_size = maze.rows;
+        set_platform_size();
+        rng_seed(&rng, seed, 0);
+        printf("Loaded %dx%d maze from %s in %.3f ms\n", maze_x_size, maze_z_size, load_file,
+               (now_seconds() - load_start) * 1000.0);
+    } else {
+        prompt_user();
+        rng_seed(&rng, seed, 0);
+        printf("Seed: %llu\n", (unsigned long long)seed);
+
+        //generate and print the maze
+        double gen_start = now_seconds();
+        // always the per chamber generator so the seed gives the same maze whatever --threads is
+        long chambers = make_maze_parallel(&maze, maze_z_size, maze_x_size, seed, gen_threads);
+        double gen_seconds = now_seconds() - gen_start;
+        printf("Split %ld chambers in %.3f ms (%.0f chambers/s)\n", chambers, gen_seconds * 1000.0,
+               gen_seconds > 0 ? chambers / gen_seconds : 0.0);
+        if (save_file && !maze_save(&maze, save_file, seed, MAZE_GEN_DIVISION_PARALLEL)) {
+            exit(EXIT_FAILURE);
+        }
+    }
+    if (export_file && !export_maze_file(&maze, export_file, export_format_from_filename(export_file))) {
+        exit(EXIT_FAILURE);
+    }
+    // the z/k/x keys solve it, so it has to fit the solvers' int cell numbers
+    if (!maze_fits_solvers(maze.rows, maze.cols)) {
+        exit(EXIT_FAILURE);
+    }
+    // big mazes would just flood the terminal, --export them instead
+    if ((long)maze.rows * maze.cols <= 100 * 100) {
+        printf("Generated Maze:\n");
+        print_maze(&maze);
+    }
 
-    //generate and print the maze
-    make_maze(maze_z_size, maze_x_size);
-    printf("Generated Maze:\n");
-    print_maze(maze_z_size, maze_x_size);
+    // build whatever the 'z' solver caches now rather than on the first key press
+    if (path_solver->solve == solve_field) {
+        double field_start = now_seconds();
+        goal_field_build(&solver_ws.field, &maze, maze_exit(&maze));
+        printf("Built the exit distance field in %.3f ms\n", (now_seconds() - field_start) * 1000.0);
+    } else if (path_solver->solve == solve_hpa) {
+        double hpa_start = now_seconds();
+        hpa_index_build(&solver_ws.hpa, &maze);
+        printf("Built the hpa index in %.3f ms: %d nodes, %zu edges, %zu kB\n", (now_seconds() - hpa_start) * 1000.0,
+               solver_ws.hpa.num_nodes, solver_ws.hpa.num_edges, hpa_index_bytes(&solver_ws.hpa) / 1024);
+    }
 
     glutInit(&argc, argv);
     glutInitDisplayMode(GLUT_RGBA | GLUT_DOUBLE | GLUT_DEPTH);
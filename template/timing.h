@@ -0,0 +1,13 @@
+#ifndef _TIMING_H_
+#define _TIMING_H_
+
+#include <time.h>
+
+//wall clock time in seconds, for timing generation and solving
+static inline double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+#endif